@@ -17,28 +17,10 @@ this program. If not, see <https://www.gnu.org/licenses/>.
 ******************************************************************************/
 
 #include "CPU.h"
+#include "Opcodes.h"
 
 #include <iostream>
 
-static uint8_t Cycles[256] = {
-    7,6,2,2,3,3,5,5,3,2,2,2,2,4,6,5,
-    2,5,3,2,3,4,6,5,2,4,2,2,4,4,7,5,
-    6,6,2,2,3,3,5,5,4,2,2,2,4,4,6,5,
-    2,5,3,2,4,4,6,5,2,4,2,2,4,4,7,5,
-    6,6,2,2,2,3,5,5,3,2,2,2,3,4,6,5,
-    2,5,3,2,2,4,6,5,2,4,3,2,2,4,7,5,
-    6,6,2,2,2,3,5,5,4,2,2,2,5,4,6,5,
-    2,5,3,2,4,4,6,5,2,4,4,2,2,4,7,5,
-    2,6,2,2,3,3,3,5,2,2,2,2,4,4,4,5,
-    2,6,4,2,4,4,4,5,2,5,2,2,4,5,5,5,
-    2,6,2,2,3,3,3,5,2,2,2,2,4,4,4,5,
-    2,5,3,2,4,4,4,5,2,4,2,2,4,4,4,5,
-    2,6,2,2,3,3,5,5,2,2,2,2,4,4,6,5,
-    2,5,3,2,2,4,6,5,2,4,3,2,2,4,7,5,
-    2,6,2,2,3,3,5,5,2,2,2,2,4,4,6,5,
-    2,5,3,2,2,4,6,5,2,4,4,2,2,4,7,5,
-};
-
 static uint8_t ZNTable[256] = {
     FLAG::Z,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
     0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
@@ -217,13 +199,44 @@ void CPU::interupt(INT type) {
     }
 }
 
+void CPU::addStepHook(const void *owner, std::function<void(uint16_t, uint8_t, uint8_t)> hook) {
+    removeStepHook(owner);
+    steps.emplace_back(owner, std::move(hook));
+}
+
+void CPU::removeStepHook(const void *owner) {
+    std::erase_if(steps, [owner](const auto &step) { return step.first == owner; });
+}
+
 int32_t CPU::run() {
+    halted = false;
+
+    // the unhooked loop is compiled without any hook or break checks
+    return steps.empty() && !break_check ? execute<false>() : execute<true>();
+}
+
+template <bool Hooked> int32_t CPU::execute() {
     WordBytes J, K;
     uint8_t I;
 
     while (true) {
+        if constexpr (Hooked) {
+            if (break_check && break_check(PC.W)) {
+                halted = true;
+                return count;
+            }
+        }
+
         I = read(PC.W++);
-        count -= Cycles[I];
+        count -= Opcodes[I].cycles;
+        cycles += Opcodes[I].cycles;
+        instructions++;
+
+        if constexpr (Hooked) {
+            for (const auto &step : steps)
+                step.second(PC.W - 1, I, Opcodes[I].cycles);
+        }
+
         switch (I) {
             case 0x00: // BRK
                 PC.W++;
@@ -695,9 +708,9 @@ int32_t CPU::run() {
                 M_FL(Y);
                 break;
 
-            case 0x89: //
+            case 0x89: // BIT #$ss IMM
                 MR_Im(I);
-                M_BIT(I);
+                M_BIT_IMM(I);
                 break;
 
             case 0x8A: // TXA
@@ -1114,6 +1127,36 @@ int32_t CPU::run() {
     }
 }
 
+void CPU::saveState(State &state) const {
+    state.PC = PC.W;
+    state.period = period;
+    state.count = count;
+    state.request = request;
+    state.after = after;
+    state.backup = backup;
+    state.A = A;
+    state.P = P;
+    state.X = X;
+    state.Y = Y;
+    state.S = S;
+}
+
+void CPU::loadState(const State &state) {
+    halted = false;
+
+    PC.W = state.PC;
+    period = state.period;
+    count = state.count;
+    request = state.request;
+    after = state.after;
+    backup = state.backup;
+    A = state.A;
+    P = state.P;
+    X = state.X;
+    Y = state.Y;
+    S = state.S;
+}
+
 CPU::~CPU() {
 
 }
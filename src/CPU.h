@@ -21,6 +21,8 @@ this program. If not, see <https://www.gnu.org/licenses/>.
 
 #include <cstdint>
 #include <functional>
+#include <utility>
+#include <vector>
 
 enum INT : uint8_t {
     NONE    = 0,
@@ -64,10 +66,24 @@ class CPU {
     uint8_t Y;
     uint8_t S;
 
+    // running totals for profiling, not part of the machine state
+    uint64_t instructions = 0;
+    uint64_t cycles = 0;
+
     std::function<uint8_t(uint16_t)> read;
     std::function<void(uint16_t, uint8_t)> write;
     std::function<uint8_t()> loop;
 
+    // called with the PC, opcode and cycle cost of every instruction
+    std::vector<std::pair<const void *, std::function<void(uint16_t, uint8_t, uint8_t)>>> steps;
+
+    // polled before every instruction in the hooked loop, returning true
+    // stops run() with that instruction not yet executed
+    std::function<bool(uint16_t)> break_check;
+    bool halted = false;
+
+    template <bool Hooked> int32_t execute();
+
     void M_ADC(uint8_t &Rg);
     void M_FL(uint8_t Rg);
 
@@ -292,6 +308,11 @@ class CPU {
         P |= (Rg & (FLAG::N|FLAG::V)) | (Rg & A? 0 : FLAG::Z);
     }
 
+    // the 65C02's BIT #imm leaves N and V alone
+    inline void M_BIT_IMM(uint8_t Rg) {
+        P = (P & ~FLAG::Z) | (Rg & A ? 0 : FLAG::Z);
+    }
+
     void M_CMP(WordBytes &K, uint8_t Rg1, uint8_t Rg2);
 
     inline void M_TSB(uint8_t &Data) {
@@ -362,6 +383,22 @@ class CPU {
 
     void SBCInstruction(uint8_t val);
 public:
+    struct State {
+        uint16_t PC;
+        int32_t period;
+        int32_t count;
+        uint8_t request;
+        uint8_t after;
+        int32_t backup;
+        uint8_t A;
+        uint8_t P;
+        uint8_t X;
+        uint8_t Y;
+        uint8_t S;
+
+        bool operator==(const State &) const = default;
+    };
+
     CPU(std::function<uint8_t(uint16_t)> read, std::function<void(uint16_t, uint8_t)> write, std::function<uint8_t()> loop);
 
     void setPeriod(int32_t new_period) {
@@ -372,6 +409,41 @@ public:
     int32_t run();
     void interupt(INT type);
 
+    uint64_t instructionCount() const {
+        return instructions;
+    }
+
+    uint64_t cycleCount() const {
+        return cycles;
+    }
+
+    // puts the counters back after a rolled back run, they are not part of State
+    void restoreCounts(uint64_t instruction_count, uint64_t cycle_count) {
+        instructions = instruction_count;
+        cycles = cycle_count;
+    }
+
+    // hooks are keyed by owner, run() only checks for them when any are set
+    void addStepHook(const void *owner, std::function<void(uint16_t, uint8_t, uint8_t)> hook);
+    void removeStepHook(const void *owner);
+
+    void setBreakCheck(std::function<bool(uint16_t)> check) {
+        break_check = std::move(check);
+    }
+
+    // true when the last run() was stopped by the break check
+    bool stopped() const {
+        return halted;
+    }
+
+    void setBus(std::function<uint8_t(uint16_t)> new_read, std::function<void(uint16_t, uint8_t)> new_write) {
+        read = std::move(new_read);
+        write = std::move(new_write);
+    }
+
+    void saveState(State &state) const;
+    void loadState(const State &state);
+
     ~CPU();
 };
 
@@ -0,0 +1,270 @@
+/******************************************************************************
+
+Copyright (C) 2025 Neil Richardson (nrich@neiltopia.com)
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, version 3.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+
+******************************************************************************/
+
+
+#include <cstring>
+#include <iostream>
+
+#include <miniz.h>
+
+#include "Capture.h"
+#include "Trace.h"
+
+Capture::Capture() : video_active(false), video_frames(0) {
+    encoder = std::thread(&Capture::encode, this);
+}
+
+std::unique_ptr<Capture::Shades> Capture::acquire() {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    if (pool.empty())
+        return std::make_unique<Shades>();
+
+    std::unique_ptr<Shades> shades = std::move(pool.back());
+    pool.pop_back();
+
+    return shades;
+}
+
+void Capture::submit(Job &&job) {
+    std::unique_lock<std::mutex> lock(mutex);
+
+    job_done.wait(lock, [this]() { return queue.size() < MaxQueued; });
+
+    queue.push_back(std::move(job));
+    in_flight++;
+
+    job_ready.notify_one();
+}
+
+void Capture::screenshot(const LCD &lcd, const Palette &palette, const std::string &filename, int32_t scale) {
+    Job job;
+    job.kind = Screenshot;
+    job.shades = acquire();
+    job.palette = palette;
+    job.filename = filename;
+    job.scale = std::max(scale, 1);
+
+    lcd.render(*job.shades);
+
+    submit(std::move(job));
+}
+
+void Capture::startVideo(const std::string &filename, int32_t scale) {
+    stopVideo();
+
+    Job job;
+    job.kind = VideoStart;
+    job.filename = filename;
+    job.scale = std::max(scale, 1);
+
+    video_frames = 0;
+    video_active = true;
+
+    submit(std::move(job));
+}
+
+void Capture::videoFrame(const LCD &lcd, const Palette &palette) {
+    if (!video_active)
+        return;
+
+    Job job;
+    job.kind = VideoFrame;
+    job.shades = acquire();
+    job.palette = palette;
+
+    lcd.render(*job.shades);
+
+    submit(std::move(job));
+}
+
+void Capture::stopVideo() {
+    if (!video_active)
+        return;
+
+    video_active = false;
+
+    Job job;
+    job.kind = VideoStop;
+
+    submit(std::move(job));
+}
+
+void Capture::flush() {
+    std::unique_lock<std::mutex> lock(mutex);
+
+    job_done.wait(lock, [this]() { return in_flight == 0; });
+}
+
+void Capture::encode() {
+    Trace::NameThread("Capture encoder");
+
+    while (true) {
+        Job job;
+
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+
+            job_ready.wait(lock, [this]() { return stopping || !queue.empty(); });
+
+            // anything still queued is written before stopping
+            if (queue.empty())
+                break;
+
+            job = std::move(queue.front());
+            queue.pop_front();
+        }
+
+        Trace::Zone zone("Encode");
+
+        switch (job.kind) {
+            case Screenshot:
+                writeScreenshot(job);
+                break;
+            case VideoStart:
+                closeVideo();
+
+                video = std::fopen(job.filename.c_str(), "wb");
+                video_filename = job.filename;
+                video_scale = job.scale;
+
+                if (!video) {
+                    std::cerr << "Could not open video file " << job.filename << "\n";
+                    video_active = false;
+                } else {
+                    // exact frame rate is CPUClock / FrameCycles
+                    std::fprintf(video, "YUV4MPEG2 W%d H%d F%d:%d Ip A1:1 C444\n", LCD::ScreenWidth * video_scale, LCD::ScreenHeight * video_scale, CPUClock, FrameCycles);
+                }
+                break;
+            case VideoFrame:
+                writeVideoFrame(job);
+                break;
+            case VideoStop:
+                closeVideo();
+                break;
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+
+        if (job.shades)
+            pool.push_back(std::move(job.shades));
+
+        in_flight--;
+        job_done.notify_all();
+    }
+
+    closeVideo();
+}
+
+void Capture::writeScreenshot(const Job &job) {
+    const int32_t width = LCD::ScreenWidth * job.scale;
+    const int32_t height = LCD::ScreenHeight * job.scale;
+
+    std::vector<uint8_t> rgb(width * height * 3);
+
+    for (int32_t y = 0; y < height; y++) {
+        const uint8_t *row = job.shades->data() + (y / job.scale) * LCD::ScreenWidth;
+        uint8_t *out = rgb.data() + y * width * 3;
+
+        for (int32_t x = 0; x < width; x++) {
+            uint32_t colour = job.palette[row[x / job.scale]];
+
+            *out++ = colour & 0xFF;
+            *out++ = (colour >> 8) & 0xFF;
+            *out++ = (colour >> 16) & 0xFF;
+        }
+    }
+
+    size_t png_size = 0;
+    void *png = tdefl_write_image_to_png_file_in_memory_ex(rgb.data(), width, height, 3, &png_size, MZ_DEFAULT_LEVEL, MZ_FALSE);
+
+    FILE *fh = png ? std::fopen(job.filename.c_str(), "wb") : nullptr;
+
+    if (!fh || std::fwrite(png, 1, png_size, fh) != png_size) {
+        std::cerr << "Could not write screenshot " << job.filename << "\n";
+    }
+
+    if (fh)
+        std::fclose(fh);
+
+    mz_free(png);
+}
+
+void Capture::writeVideoFrame(const Job &job) {
+    if (!video)
+        return;
+
+    const int32_t width = LCD::ScreenWidth * video_scale;
+    const int32_t height = LCD::ScreenHeight * video_scale;
+    const size_t plane_size = width * height;
+
+    // BT.601 studio range, the same for every pixel of a shade
+    std::array<std::array<uint8_t, 4>, 3> yuv;
+
+    for (int shade = 0; shade < 4; shade++) {
+        int32_t r = job.palette[shade] & 0xFF;
+        int32_t g = (job.palette[shade] >> 8) & 0xFF;
+        int32_t b = (job.palette[shade] >> 16) & 0xFF;
+
+        yuv[0][shade] = 16 + ((66 * r + 129 * g + 25 * b + 128) >> 8);
+        yuv[1][shade] = 128 + ((-38 * r - 74 * g + 112 * b + 128) >> 8);
+        yuv[2][shade] = 128 + ((112 * r - 94 * g - 18 * b + 128) >> 8);
+    }
+
+    video_frame.resize(plane_size * 3);
+
+    for (int32_t plane = 0; plane < 3; plane++) {
+        uint8_t *out = video_frame.data() + plane * plane_size;
+
+        for (int32_t y = 0; y < height; y++) {
+            const uint8_t *row = job.shades->data() + (y / video_scale) * LCD::ScreenWidth;
+
+            for (int32_t x = 0; x < width; x++) {
+                *out++ = yuv[plane][row[x / video_scale]];
+            }
+        }
+    }
+
+    if (std::fputs("FRAME\n", video) < 0 || std::fwrite(video_frame.data(), 1, video_frame.size(), video) != video_frame.size()) {
+        std::cerr << "Could not write video file " << video_filename << "\n";
+        closeVideo();
+        video_active = false;
+        return;
+    }
+
+    video_frames++;
+}
+
+void Capture::closeVideo() {
+    if (video) {
+        std::fclose(video);
+        video = nullptr;
+    }
+}
+
+Capture::~Capture() {
+    stopVideo();
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+
+    job_ready.notify_one();
+    encoder.join();
+}
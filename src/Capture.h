@@ -0,0 +1,119 @@
+/******************************************************************************
+
+Copyright (C) 2025 Neil Richardson (nrich@neiltopia.com)
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, version 3.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+
+******************************************************************************/
+
+
+#ifndef CAPTURE_H
+#define CAPTURE_H
+
+#include <cstdint>
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Emulation.h"
+#include "LCD.h"
+
+/*
+    Screenshots (PNG) and video (Y4M) written by a background encoder.
+    The emulation thread only renders the LCD shades into a pooled
+    buffer and queues it, palette expansion, scaling, compression and
+    file writes all happen on the encoder thread. The queue is bounded,
+    when the encoder falls behind the emulation waits rather than drop
+    video frames.
+*/
+class Capture {
+public:
+    typedef std::array<uint8_t, LCD::ScreenWidth*LCD::ScreenHeight> Shades;
+private:
+    enum Kind {
+        Screenshot,
+        VideoStart,
+        VideoFrame,
+        VideoStop,
+    };
+
+    struct Job {
+        Kind kind;
+        std::unique_ptr<Shades> shades;
+        Palette palette;
+        std::string filename;
+        int32_t scale;
+    };
+
+    static const size_t MaxQueued = 32;
+
+    std::mutex mutex;
+    std::condition_variable job_ready;
+    std::condition_variable job_done;
+    std::deque<Job> queue;
+    std::vector<std::unique_ptr<Shades>> pool;
+    bool stopping = false;
+    size_t in_flight = 0;
+
+    std::thread encoder;
+
+    // encoder thread only
+    FILE *video = nullptr;
+    std::string video_filename;
+    int32_t video_scale = 1;
+    std::vector<uint8_t> video_frame;
+
+    std::atomic<bool> video_active;
+    std::atomic<uint32_t> video_frames;
+
+    std::unique_ptr<Shades> acquire();
+    void submit(Job &&job);
+
+    void encode();
+    void writeScreenshot(const Job &job);
+    void writeVideoFrame(const Job &job);
+    void closeVideo();
+public:
+    Capture();
+
+    Capture(const Capture &) = delete;
+    Capture &operator=(const Capture &) = delete;
+
+    void screenshot(const LCD &lcd, const Palette &palette, const std::string &filename, int32_t scale);
+
+    void startVideo(const std::string &filename, int32_t scale);
+    void videoFrame(const LCD &lcd, const Palette &palette);
+    void stopVideo();
+
+    bool recording() const {
+        return video_active;
+    }
+
+    uint32_t videoFrames() const {
+        return video_frames;
+    }
+
+    // blocks until everything queued so far is written
+    void flush();
+
+    ~Capture();
+};
+
+#endif //CAPTURE_H
@@ -0,0 +1,240 @@
+/******************************************************************************
+
+Copyright (C) 2025 Neil Richardson (nrich@neiltopia.com)
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, version 3.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+
+******************************************************************************/
+
+
+#include <algorithm>
+#include <bit>
+#include <cstdio>
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "CheatSearch.h"
+
+template <CheatSearch::Compare compare>
+static inline bool keep(uint8_t current, uint8_t previous, uint8_t value) {
+    switch (compare) {
+        case CheatSearch::Unchanged:
+            return current == previous;
+        case CheatSearch::Changed:
+            return current != previous;
+        case CheatSearch::Increased:
+            return current > previous;
+        case CheatSearch::Decreased:
+            return current < previous;
+        case CheatSearch::IncreasedBy:
+            return current == (uint8_t)(previous + value);
+        case CheatSearch::DecreasedBy:
+            return current == (uint8_t)(previous - value);
+        default:
+            return current == value;
+    }
+}
+
+#if defined(__SSE2__)
+template <CheatSearch::Compare compare>
+static inline __m128i keep(__m128i current, __m128i previous, __m128i value) {
+    switch (compare) {
+        case CheatSearch::Unchanged:
+            return _mm_cmpeq_epi8(current, previous);
+        case CheatSearch::Changed:
+            return _mm_xor_si128(_mm_cmpeq_epi8(current, previous), _mm_set1_epi8(-1));
+        case CheatSearch::Increased:
+            // unsigned current > previous: max is current and they differ
+            return _mm_andnot_si128(_mm_cmpeq_epi8(current, previous), _mm_cmpeq_epi8(_mm_max_epu8(current, previous), current));
+        case CheatSearch::Decreased:
+            return _mm_andnot_si128(_mm_cmpeq_epi8(current, previous), _mm_cmpeq_epi8(_mm_min_epu8(current, previous), current));
+        case CheatSearch::IncreasedBy:
+            return _mm_cmpeq_epi8(current, _mm_add_epi8(previous, value));
+        case CheatSearch::DecreasedBy:
+            return _mm_cmpeq_epi8(current, _mm_sub_epi8(previous, value));
+        default:
+            return _mm_cmpeq_epi8(current, value);
+    }
+}
+#endif
+
+template <CheatSearch::Compare compare>
+static size_t narrow_mask(uint8_t *mask, const uint8_t *current, const uint8_t *previous, size_t size, uint8_t value) {
+    size_t remaining = 0;
+    size_t i = 0;
+
+#if defined(__SSE2__)
+    const __m128i values = _mm_set1_epi8((char)value);
+
+    for (; i + 16 <= size; i += 16) {
+        __m128i block = _mm_loadu_si128((const __m128i *)(mask + i));
+
+        // most of the mask is empty after a few searches
+        if (!_mm_movemask_epi8(block))
+            continue;
+
+        __m128i a = _mm_loadu_si128((const __m128i *)(current + i));
+        __m128i b = _mm_loadu_si128((const __m128i *)(previous + i));
+
+        block = _mm_and_si128(block, keep<compare>(a, b, values));
+        _mm_storeu_si128((__m128i *)(mask + i), block);
+
+        remaining += std::popcount((uint32_t)_mm_movemask_epi8(block));
+    }
+#endif
+
+    for (; i < size; i++) {
+        if (mask[i] && !keep<compare>(current[i], previous[i], value))
+            mask[i] = 0x00;
+
+        remaining += mask[i] ? 1 : 0;
+    }
+
+    return remaining;
+}
+
+CheatSearch::CheatSearch(size_t budget) : budget(budget) {
+    restart();
+}
+
+void CheatSearch::setVRAM(bool vram) {
+    if (vram == include_vram)
+        return;
+
+    include_vram = vram;
+    snapshot_size = RAMSize + (vram ? 2 * PlaneSize : 0);
+
+    snapshots.clear();
+    snapshots.shrink_to_fit();
+    capacity = 0;
+
+    clear();
+}
+
+void CheatSearch::capture(const Gamate &gamate) {
+    if (!capacity) {
+        capacity = std::max<size_t>(budget / snapshot_size, 2);
+        snapshots.resize(capacity * snapshot_size);
+    }
+
+    uint8_t *out = snapshots.data() + (captured % capacity) * snapshot_size;
+
+    std::memcpy(out, gamate.running_state.RAM.data(), RAMSize);
+
+    if (include_vram) {
+        std::memcpy(out + RAMSize, gamate.lcd.bitPlane(0).data(), PlaneSize);
+        std::memcpy(out + RAMSize + PlaneSize, gamate.lcd.bitPlane(1).data(), PlaneSize);
+    }
+
+    captured++;
+}
+
+void CheatSearch::clear() {
+    captured = 0;
+    restart();
+}
+
+void CheatSearch::restart() {
+    candidates.assign(snapshot_size, 0xFF);
+    remaining = snapshot_size;
+    reference = captured ? captured - 1 : 0;
+}
+
+size_t CheatSearch::Narrow(uint8_t *mask, const uint8_t *current, const uint8_t *previous, size_t size, Compare compare, uint8_t value) {
+    // one loop per compare so the vector body has no branches
+    switch (compare) {
+        case Unchanged:
+            return narrow_mask<Unchanged>(mask, current, previous, size, value);
+        case Changed:
+            return narrow_mask<Changed>(mask, current, previous, size, value);
+        case Increased:
+            return narrow_mask<Increased>(mask, current, previous, size, value);
+        case Decreased:
+            return narrow_mask<Decreased>(mask, current, previous, size, value);
+        case IncreasedBy:
+            return narrow_mask<IncreasedBy>(mask, current, previous, size, value);
+        case DecreasedBy:
+            return narrow_mask<DecreasedBy>(mask, current, previous, size, value);
+        default:
+            return narrow_mask<EqualTo>(mask, current, previous, size, value);
+    }
+}
+
+size_t CheatSearch::narrow(Compare compare, uint8_t value) {
+    if (!captured)
+        return remaining;
+
+    uint64_t latest = captured - 1;
+
+    // the reference may have dropped out of the ring
+    reference = std::max(reference, firstFrame());
+
+    remaining = Narrow(candidates.data(), snapshot(latest), snapshot(reference), snapshot_size, compare, value);
+    reference = latest;
+
+    return remaining;
+}
+
+size_t CheatSearch::narrowSeries(Compare compare, uint8_t value, uint64_t first, uint64_t last) {
+    if (!captured)
+        return remaining;
+
+    first = std::max(first, firstFrame() + (compare == EqualTo ? 0 : 1));
+    last = std::min(last, captured - 1);
+
+    for (uint64_t frame = first; frame <= last && remaining; frame++) {
+        const uint8_t *previous = snapshot(frame > 0 ? frame - 1 : frame);
+
+        remaining = Narrow(candidates.data(), snapshot(frame), previous, snapshot_size, compare, value);
+    }
+
+    reference = captured - 1;
+
+    return remaining;
+}
+
+std::vector<CheatSearch::Candidate> CheatSearch::list(size_t limit) const {
+    std::vector<Candidate> out;
+
+    const uint8_t *latest = captured ? snapshot(captured - 1) : nullptr;
+    const uint8_t *previous = captured ? snapshot(std::max(reference, firstFrame())) : nullptr;
+
+    for (size_t i = 0; i < candidates.size() && out.size() < limit; i++) {
+        if (!candidates[i])
+            continue;
+
+        out.push_back({(uint32_t)i, latest ? latest[i] : (uint8_t)0, previous ? previous[i] : (uint8_t)0});
+    }
+
+    return out;
+}
+
+std::string CheatSearch::FormatOffset(uint32_t offset) {
+    char text[16];
+
+    if (offset < RAMSize) {
+        snprintf(text, sizeof(text), "%04X", offset);
+    } else {
+        offset -= RAMSize;
+        snprintf(text, sizeof(text), "VRAM%u:%04X", offset / (uint32_t)PlaneSize, offset % (uint32_t)PlaneSize);
+    }
+
+    return text;
+}
+
+CheatSearch::~CheatSearch() {
+
+}
@@ -0,0 +1,145 @@
+/******************************************************************************
+
+Copyright (C) 2025 Neil Richardson (nrich@neiltopia.com)
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, version 3.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+
+******************************************************************************/
+
+
+#ifndef CHEATSEARCH_H
+#define CHEATSEARCH_H
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "Gamate.h"
+
+/*
+    Cheat finder over per frame snapshots of RAM (and optionally both VRAM
+    bitplanes). Snapshots are kept in a ring sized by a memory budget and
+    allocated on first capture. Candidates are a byte mask over a snapshot
+    that each search narrows with a 16 bytes at a time compare of whole
+    snapshots, blocks with no candidates left are skipped, so a search over
+    thousands of retained frames of a movie takes milliseconds.
+*/
+class CheatSearch {
+public:
+    enum Compare : uint8_t {
+        Unchanged,
+        Changed,
+        Increased,
+        Decreased,
+        IncreasedBy,
+        DecreasedBy,
+        EqualTo, // the value itself, not a difference
+    };
+
+    struct Candidate {
+        uint32_t offset; // into a snapshot, RAM first then the bitplanes
+        uint8_t value; // in the latest snapshot
+        uint8_t previous; // in the reference snapshot
+    };
+
+    static const size_t RAMSize = 1024;
+    static const size_t PlaneSize = 0x2000;
+private:
+    size_t budget;
+    bool include_vram = false;
+    bool active = false;
+
+    size_t snapshot_size = RAMSize;
+    size_t capacity = 0;
+    std::vector<uint8_t> snapshots;
+
+    // frames captured since the last clear, the ring holds the most recent
+    uint64_t captured = 0;
+    uint64_t reference = 0;
+
+    std::vector<uint8_t> candidates;
+    size_t remaining = 0;
+
+    const uint8_t *snapshot(uint64_t frame) const {
+        return snapshots.data() + (frame % capacity) * snapshot_size;
+    }
+public:
+    CheatSearch(size_t budget = 16 * 1024 * 1024);
+
+    CheatSearch(const CheatSearch &) = delete;
+    CheatSearch &operator=(const CheatSearch &) = delete;
+
+    void enable() {
+        active = true;
+    }
+
+    void disable() {
+        active = false;
+    }
+
+    bool enabled() const {
+        return active;
+    }
+
+    // changing what is captured drops the snapshots and the search
+    void setVRAM(bool vram);
+
+    bool vram() const {
+        return include_vram;
+    }
+
+    void capture(const Gamate &gamate);
+
+    void clear();
+
+    // every byte becomes a candidate again, compared from the latest snapshot on
+    void restart();
+
+    // keeps candidates whose latest value compares with the reference
+    // snapshot, the latest becomes the new reference
+    size_t narrow(Compare compare, uint8_t value = 0);
+
+    // keeps candidates that compare true between every retained snapshot
+    // in first..last and the one before it
+    size_t narrowSeries(Compare compare, uint8_t value, uint64_t first, uint64_t last);
+
+    size_t count() const {
+        return remaining;
+    }
+
+    // retained snapshots are frames firstFrame() up to frames()-1
+    uint64_t frames() const {
+        return captured;
+    }
+
+    uint64_t firstFrame() const {
+        return captured > capacity ? captured - capacity : 0;
+    }
+
+    uint64_t referenceFrame() const {
+        return reference;
+    }
+
+    std::vector<Candidate> list(size_t limit) const;
+
+    // RAM offsets as CPU addresses, bitplanes as VRAM0:1FFF
+    static std::string FormatOffset(uint32_t offset);
+
+    // mask &= compare(current, previous) per byte, returns the bytes left
+    static size_t Narrow(uint8_t *mask, const uint8_t *current, const uint8_t *previous, size_t size, Compare compare, uint8_t value);
+
+    ~CheatSearch();
+};
+
+#endif //CHEATSEARCH_H
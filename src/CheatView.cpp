@@ -0,0 +1,245 @@
+/******************************************************************************
+
+Copyright (C) 2025 Neil Richardson (nrich@neiltopia.com)
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, version 3.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+
+******************************************************************************/
+
+
+#include <algorithm>
+#include <iostream>
+
+#include <imgui.h>
+
+#include "CheatView.h"
+
+static const size_t MaxShownCandidates = 1000;
+
+CheatView::CheatView(Gamate &gamate, Cheats &cheats, CheatSearch &search) : gamate(gamate), cheats(cheats), search(search) {
+
+}
+
+void CheatView::menu() {
+    if (ImGui::MenuItem("Cheats", "", &show_cheats)) {
+    }
+}
+
+void CheatView::draw(const Emulator &emulator) {
+    if (emulator.rom != rom_path) {
+        rom_path = emulator.rom;
+        cheat_path = rom_path.length() ? emulator.cheatPath() : "";
+
+        if (cheat_path.empty()) {
+            cheats.clear();
+        } else if (!cheats.load(cheat_path)) {
+            std::cerr << "Could not read cheat file " << cheat_path << "\n";
+        }
+
+        cheats.apply(gamate);
+        search.clear();
+    }
+
+    if (!show_cheats)
+        return;
+
+    ImGui::SetNextWindowSize(ImVec2(460, 480), ImGuiCond_FirstUseEver);
+
+    if (ImGui::Begin("Cheats", &show_cheats)) {
+        if (ImGui::BeginTabBar("##CheatTabs")) {
+            if (ImGui::BeginTabItem("Codes")) {
+                codesTab();
+                ImGui::EndTabItem();
+            }
+
+            if (ImGui::BeginTabItem("Search")) {
+                searchTab();
+                ImGui::EndTabItem();
+            }
+
+            ImGui::EndTabBar();
+        }
+    }
+
+    ImGui::End();
+}
+
+void CheatView::changed() {
+    cheats.apply(gamate);
+
+    if (cheat_path.length() && !cheats.save(cheat_path))
+        std::cerr << "Could not write cheat file " << cheat_path << "\n";
+}
+
+void CheatView::codesTab() {
+    ImGui::SetNextItemWidth(96);
+    bool add = ImGui::InputTextWithHint("##Code", "0123:09", code_text, sizeof(code_text), ImGuiInputTextFlags_EnterReturnsTrue);
+    ImGui::SameLine();
+    ImGui::SetNextItemWidth(200);
+    add = ImGui::InputTextWithHint("##Description", "Description", description_text, sizeof(description_text), ImGuiInputTextFlags_EnterReturnsTrue) || add;
+    ImGui::SameLine();
+    add = ImGui::Button("Add") || add;
+
+    if (add) {
+        Cheats::Cheat cheat = {};
+
+        if (Cheats::ParseCode(code_text, cheat)) {
+            cheat.enabled = true;
+            cheat.description = description_text;
+            cheats.add(cheat);
+            changed();
+
+            code_text[0] = 0;
+            description_text[0] = 0;
+        }
+    }
+
+    ImGui::TextDisabled("AAAA:VV reads VV at AAAA, AAAA:VV:CC only while the byte is CC");
+
+    const auto &list = cheats.list();
+
+    for (size_t i = 0; i < list.size(); i++) {
+        const auto &cheat = list[i];
+        bool enabled = cheat.enabled;
+
+        ImGui::PushID((int)i);
+        if (ImGui::Checkbox("##Enabled", &enabled)) {
+            cheats.enable(i, enabled);
+            changed();
+        }
+        ImGui::SameLine();
+        ImGui::Text("%s %s", Cheats::FormatCode(cheat).c_str(), cheat.description.c_str());
+        ImGui::SameLine();
+        bool remove = ImGui::SmallButton("Remove");
+        ImGui::PopID();
+
+        if (remove) {
+            cheats.remove(i);
+            changed();
+            break;
+        }
+    }
+}
+
+void CheatView::searchTab() {
+    bool recording = search.enabled();
+
+    if (ImGui::Checkbox("Record snapshots", &recording)) {
+        if (recording)
+            search.enable();
+        else
+            search.disable();
+    }
+
+    ImGui::SameLine();
+
+    bool vram = search.vram();
+    if (ImGui::Checkbox("Include VRAM", &vram))
+        search.setVRAM(vram);
+
+    ImGui::SameLine();
+
+    if (ImGui::Button("Restart"))
+        search.restart();
+
+    uint64_t frames = search.frames();
+    uint64_t first = search.firstFrame();
+
+    ImGui::Text("Frames %llu-%llu retained, %zu candidates", (unsigned long long)first, (unsigned long long)(frames ? frames - 1 : 0), search.count());
+
+    ImGui::SetNextItemWidth(140);
+    ImGui::Combo("##Compare", &compare, "Unchanged\0Changed\0Increased\0Decreased\0Increased by\0Decreased by\0Equal to\0\0");
+
+    bool has_value = compare == CheatSearch::IncreasedBy || compare == CheatSearch::DecreasedBy || compare == CheatSearch::EqualTo;
+
+    if (has_value) {
+        ImGui::SameLine();
+        ImGui::SetNextItemWidth(80);
+        ImGui::InputInt("##Value", &compare_value);
+        compare_value = std::clamp(compare_value, 0, 255);
+    }
+
+    ImGui::BeginDisabled(frames == 0);
+
+    ImGui::SameLine();
+    if (ImGui::Button("Search")) {
+        // against the snapshot of the previous search
+        search.narrow((CheatSearch::Compare)compare, (uint8_t)compare_value);
+    }
+
+    // the same compare between every pair of frames in a range, e.g. over a movie
+    int32_t lowest = (int32_t)first;
+    int32_t highest = frames ? (int32_t)frames - 1 : 0;
+
+    series_first = std::clamp(series_first, lowest, highest);
+    series_last = std::clamp(series_last ? series_last : highest, series_first, highest);
+
+    ImGui::SetNextItemWidth(120);
+    ImGui::DragIntRange2("Frames", &series_first, &series_last, 1.0f, lowest, highest);
+    ImGui::SameLine();
+
+    if (ImGui::Button("Search Every Frame")) {
+        search.narrowSeries((CheatSearch::Compare)compare, (uint8_t)compare_value, series_first, series_last);
+    }
+
+    ImGui::EndDisabled();
+
+    shown = search.list(MaxShownCandidates);
+
+    if (search.count() > shown.size())
+        ImGui::TextDisabled("Showing the first %zu", shown.size());
+
+    if (ImGui::BeginTable("##Candidates", 4, ImGuiTableFlags_RowBg | ImGuiTableFlags_ScrollY | ImGuiTableFlags_BordersInnerV)) {
+        ImGui::TableSetupScrollFreeze(0, 1);
+        ImGui::TableSetupColumn("Address");
+        ImGui::TableSetupColumn("Value");
+        ImGui::TableSetupColumn("Previous");
+        ImGui::TableSetupColumn("");
+        ImGui::TableHeadersRow();
+
+        ImGuiListClipper clipper;
+        clipper.Begin((int)shown.size());
+
+        while (clipper.Step()) {
+            for (int32_t row = clipper.DisplayStart; row < clipper.DisplayEnd; row++) {
+                const auto &candidate = shown[row];
+
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn();
+                ImGui::TextUnformatted(CheatSearch::FormatOffset(candidate.offset).c_str());
+                ImGui::TableNextColumn();
+                ImGui::Text("%02X (%u)", candidate.value, candidate.value);
+                ImGui::TableNextColumn();
+                ImGui::Text("%02X (%u)", candidate.previous, candidate.previous);
+                ImGui::TableNextColumn();
+
+                // only RAM can be patched on the bus
+                if (candidate.offset < CheatSearch::RAMSize) {
+                    ImGui::PushID(row);
+                    if (ImGui::SmallButton("Freeze")) {
+                        Cheats::Cheat cheat = {(uint16_t)candidate.offset, candidate.value, -1, true, "Found by search"};
+                        cheats.add(cheat);
+                        changed();
+                    }
+                    ImGui::PopID();
+                }
+            }
+        }
+
+        ImGui::EndTable();
+    }
+}
+
+CheatView::~CheatView() {
+
+}
@@ -0,0 +1,72 @@
+/******************************************************************************
+
+Copyright (C) 2025 Neil Richardson (nrich@neiltopia.com)
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, version 3.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+
+******************************************************************************/
+
+
+#ifndef CHEATVIEW_H
+#define CHEATVIEW_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Cheats.h"
+#include "CheatSearch.h"
+#include "Emulation.h"
+#include "Gamate.h"
+
+/*
+    ImGui cheats window: the codes for the loaded ROM, kept in its cheat
+    file and applied to the bus as soon as they change, and the snapshot
+    search for finding new ones.
+*/
+class CheatView {
+    Gamate &gamate;
+    Cheats &cheats;
+    CheatSearch &search;
+
+    bool show_cheats = false;
+
+    // ROM the loaded codes belong to
+    std::string rom_path;
+    std::string cheat_path;
+
+    char code_text[16] = "";
+    char description_text[64] = "";
+
+    int32_t compare = CheatSearch::Changed;
+    int32_t compare_value = 1;
+    int32_t series_first = 0;
+    int32_t series_last = 0;
+
+    std::vector<CheatSearch::Candidate> shown;
+
+    void changed();
+    void codesTab();
+    void searchTab();
+public:
+    CheatView(Gamate &gamate, Cheats &cheats, CheatSearch &search);
+
+    void menu();
+
+    // also loads the codes whenever another ROM is opened
+    void draw(const Emulator &emulator);
+
+    ~CheatView();
+};
+
+#endif //CHEATVIEW_H
@@ -0,0 +1,173 @@
+/******************************************************************************
+
+Copyright (C) 2025 Neil Richardson (nrich@neiltopia.com)
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, version 3.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+
+******************************************************************************/
+
+
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#include "Cheats.h"
+
+Cheats::Cheats() {
+
+}
+
+bool Cheats::ParseCode(const std::string &code, Cheat &cheat) {
+    unsigned int address = 0, value = 0, compare = 0;
+    char tail = 0;
+
+    int fields = sscanf(code.c_str(), "%x:%x:%x%c", &address, &value, &compare, &tail);
+
+    if (fields < 2 || fields > 3 || address > 0xFFFF || value > 0xFF || compare > 0xFF)
+        return false;
+
+    // sscanf stops quietly on junk after the value
+    size_t colons = 0;
+    for (char c : code) {
+        if (c == ':')
+            colons++;
+        else if (!isxdigit((unsigned char)c))
+            return false;
+    }
+
+    if (colons != (size_t)fields - 1)
+        return false;
+
+    cheat.address = address;
+    cheat.value = value;
+    cheat.compare = fields == 3 ? (int16_t)compare : -1;
+
+    return true;
+}
+
+std::string Cheats::FormatCode(const Cheat &cheat) {
+    char text[16];
+
+    if (cheat.compare < 0)
+        snprintf(text, sizeof(text), "%04X:%02X", cheat.address, cheat.value);
+    else
+        snprintf(text, sizeof(text), "%04X:%02X:%02X", cheat.address, cheat.value, cheat.compare);
+
+    return text;
+}
+
+void Cheats::add(const Cheat &cheat) {
+    cheats.push_back(cheat);
+}
+
+void Cheats::remove(size_t index) {
+    if (index < cheats.size())
+        cheats.erase(cheats.begin() + index);
+}
+
+void Cheats::enable(size_t index, bool enabled) {
+    if (index < cheats.size())
+        cheats[index].enabled = enabled;
+}
+
+void Cheats::clear() {
+    cheats.clear();
+}
+
+void Cheats::apply(Gamate &gamate) const {
+    std::vector<Gamate::Patch> patches;
+
+    for (const auto &cheat : cheats) {
+        if (cheat.enabled)
+            patches.push_back({cheat.address, cheat.value, cheat.compare});
+    }
+
+    gamate.setPatches(std::move(patches));
+}
+
+bool Cheats::load(const std::string &filename) {
+    cheats.clear();
+
+    std::error_code ec;
+    if (!std::filesystem::exists(filename, ec))
+        return true;
+
+    std::ifstream fh(filename);
+
+    if (!fh)
+        return false;
+
+    std::string line;
+
+    while (std::getline(fh, line)) {
+        if (!line.empty() && line.back() == '\r')
+            line.pop_back();
+
+        if (line.empty() || line[0] == '#')
+            continue;
+
+        std::istringstream fields(line);
+        std::string code;
+        Cheat cheat = {};
+
+        fields >> code;
+        std::getline(fields >> std::ws, cheat.description);
+
+        cheat.enabled = code[0] != '-';
+        if (!cheat.enabled)
+            code.erase(0, 1);
+
+        if (!ParseCode(code, cheat)) {
+            std::cerr << "Could not parse cheat " << line << "\n";
+            continue;
+        }
+
+        cheats.push_back(cheat);
+    }
+
+    return true;
+}
+
+bool Cheats::save(const std::string &filename) const {
+    std::error_code ec;
+
+    // don't leave empty files next to every ROM
+    if (cheats.empty()) {
+        std::filesystem::remove(filename, ec);
+        return !ec;
+    }
+
+    std::ofstream fh(filename, std::ios::out|std::ios::trunc);
+
+    if (!fh)
+        return false;
+
+    for (const auto &cheat : cheats) {
+        fh << (cheat.enabled ? "" : "-") << FormatCode(cheat);
+
+        if (!cheat.description.empty())
+            fh << " " << cheat.description;
+
+        fh << "\n";
+    }
+
+    return (bool)fh;
+}
+
+Cheats::~Cheats() {
+
+}
@@ -0,0 +1,73 @@
+/******************************************************************************
+
+Copyright (C) 2025 Neil Richardson (nrich@neiltopia.com)
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, version 3.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+
+******************************************************************************/
+
+
+#ifndef CHEATS_H
+#define CHEATS_H
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "Gamate.h"
+
+/*
+    Cheat codes for one ROM, applied as read patches on the Gamate bus.
+    A code is AAAA:VV to make reads of AAAA return VV, or AAAA:VV:CC to
+    only do so while the real byte is CC (so a ROM patch only hits the
+    right bank). Codes are kept in a text file next to the ROM, one per
+    line followed by a description, disabled ones start with '-'.
+*/
+class Cheats {
+public:
+    struct Cheat {
+        uint16_t address;
+        uint8_t value;
+        int16_t compare; // negative for always
+        bool enabled;
+        std::string description;
+    };
+private:
+    std::vector<Cheat> cheats;
+public:
+    Cheats();
+
+    static bool ParseCode(const std::string &code, Cheat &cheat);
+    static std::string FormatCode(const Cheat &cheat);
+
+    const std::vector<Cheat> &list() const {
+        return cheats;
+    }
+
+    void add(const Cheat &cheat);
+    void remove(size_t index);
+    void enable(size_t index, bool enabled);
+    void clear();
+
+    // patches the bus with the enabled codes
+    void apply(Gamate &gamate) const;
+
+    // a missing file is an empty list
+    bool load(const std::string &filename);
+    bool save(const std::string &filename) const;
+
+    ~Cheats();
+};
+
+#endif //CHEATS_H
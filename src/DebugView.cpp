@@ -0,0 +1,413 @@
+/******************************************************************************
+
+Copyright (C) 2025 Neil Richardson (nrich@neiltopia.com)
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, version 3.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+
+******************************************************************************/
+
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+#include <emu2149.h>
+#include <imgui.h>
+#include <rlImGui.h>
+
+#include "DebugView.h"
+
+static const uint32_t PlaneOn = 0xFFFFFFFF;
+static const uint32_t PlaneOff = 0xFF000000;
+
+DebugView::DebugView(Gamate &gamate, Debugger &debugger) : gamate(gamate), debugger(debugger) {
+    plane_pixels[0].resize(256 * 256);
+    plane_pixels[1].resize(256 * 256);
+}
+
+void DebugView::menu() {
+    if (ImGui::MenuItem("Debugger", "", &show_debugger)) {
+    }
+    if (ImGui::MenuItem("Memory", "", &show_memory)) {
+    }
+    if (ImGui::MenuItem("VRAM", "", &show_vram)) {
+    }
+    if (ImGui::MenuItem("Registers", "", &show_registers)) {
+    }
+}
+
+void DebugView::draw() {
+    bool has_points = false;
+
+    for (const auto &breakpoint : debugger.breakpointList())
+        has_points = has_points || breakpoint.enabled;
+    for (const auto &watchpoint : debugger.watchpointList())
+        has_points = has_points || watchpoint.enabled;
+
+    // the hooked CPU loop is slower, only run it while it can be used
+    if (show_debugger && !debugger.attached()) {
+        debugger.attach(gamate);
+    } else if (!show_debugger && !has_points && debugger.attached() && !gamate.cpu.stopped()) {
+        debugger.detach();
+    }
+
+    if (show_debugger)
+        debuggerWindow(gamate.running_state);
+    if (show_memory)
+        memoryWindow();
+    if (show_vram)
+        vramWindow();
+    if (show_registers)
+        registersWindow();
+}
+
+void DebugView::controls(RunningState &running_state) {
+    bool stopped = gamate.cpu.stopped();
+
+    if (stopped || running_state.paused) {
+        if (ImGui::Button("Continue")) {
+            debugger.resume();
+            running_state.paused = false;
+            running_state.audio_enabled = true;
+        }
+    } else {
+        if (ImGui::Button("Pause")) {
+            debugger.pause();
+        }
+    }
+
+    ImGui::SameLine();
+
+    ImGui::BeginDisabled(!running_state.paused);
+    if (ImGui::Button("Step")) {
+        // the main loop runs until the debugger stops again and pauses
+        debugger.step();
+        running_state.paused = false;
+        running_state.audio_enabled = false;
+    }
+    ImGui::EndDisabled();
+
+    ImGui::SameLine();
+
+    if (stopped)
+        ImGui::TextUnformatted(Debugger::FormatStop(debugger.lastStop()).c_str());
+    else
+        ImGui::TextUnformatted(running_state.paused ? "Paused" : "Running");
+}
+
+void DebugView::debuggerWindow(RunningState &running_state) {
+    ImGui::SetNextWindowSize(ImVec2(420, 520), ImGuiCond_FirstUseEver);
+
+    if (ImGui::Begin("Debugger", &show_debugger)) {
+        controls(running_state);
+
+        CPU::State cpu;
+        gamate.cpu.saveState(cpu);
+
+        ImGui::Text("PC:%04X A:%02X X:%02X Y:%02X S:%02X P:%c%c%c%c%c%c%c%c", cpu.PC, cpu.A, cpu.X, cpu.Y, cpu.S,
+            cpu.P & FLAG::N ? 'N' : '.', cpu.P & FLAG::V ? 'V' : '.', cpu.P & FLAG::R ? 'R' : '.', cpu.P & FLAG::B ? 'B' : '.',
+            cpu.P & FLAG::D ? 'D' : '.', cpu.P & FLAG::I ? 'I' : '.', cpu.P & FLAG::Z ? 'Z' : '.', cpu.P & FLAG::C ? 'C' : '.');
+
+        ImGui::Separator();
+
+        disassembly.around(gamate, cpu.PC, 8, 24, lines);
+
+        if (ImGui::BeginChild("##Disassembly", ImVec2(0, ImGui::GetContentRegionAvail().y * 0.55f), ImGuiChildFlags_Borders)) {
+            const auto &breakpoints = debugger.breakpointList();
+
+            for (const auto &line : lines) {
+                auto found = std::find_if(breakpoints.begin(), breakpoints.end(), [&](const Debugger::Breakpoint &breakpoint) {
+                    return breakpoint.address == line.address;
+                });
+
+                char bytes[12];
+                switch (line.length) {
+                    case 3:
+                        snprintf(bytes, sizeof(bytes), "%02X %02X %02X", line.bytes[0], line.bytes[1], line.bytes[2]);
+                        break;
+                    case 2:
+                        snprintf(bytes, sizeof(bytes), "%02X %02X", line.bytes[0], line.bytes[1]);
+                        break;
+                    default:
+                        snprintf(bytes, sizeof(bytes), "%02X", line.bytes[0]);
+                }
+
+                char text[64];
+                snprintf(text, sizeof(text), "%c%c %04X  %-8s  %s", found != breakpoints.end() ? '*' : ' ', line.address == cpu.PC ? '>' : ' ', line.address, bytes, line.text);
+
+                ImGui::PushID(line.address);
+                if (ImGui::Selectable(text, line.address == cpu.PC, ImGuiSelectableFlags_AllowDoubleClick) && ImGui::IsMouseDoubleClicked(ImGuiMouseButton_Left)) {
+                    // double click toggles a breakpoint
+                    if (found != breakpoints.end())
+                        debugger.removeBreakpoint(found - breakpoints.begin());
+                    else
+                        debugger.addBreakpoint(line.address);
+                }
+                ImGui::PopID();
+            }
+        }
+        ImGui::EndChild();
+
+        if (ImGui::CollapsingHeader("Breakpoints", ImGuiTreeNodeFlags_DefaultOpen)) {
+            ImGui::SetNextItemWidth(200);
+            bool add = ImGui::InputTextWithHint("##Breakpoint", "E007 [if A == $10]", breakpoint_text, sizeof(breakpoint_text), ImGuiInputTextFlags_EnterReturnsTrue);
+            ImGui::SameLine();
+            add = ImGui::Button("Add##Breakpoint") || add;
+
+            if (add) {
+                std::string text = breakpoint_text;
+                std::string condition_text;
+                size_t split = text.find(" if ");
+
+                if (split != std::string::npos) {
+                    condition_text = text.substr(split + 4);
+                    text = text.substr(0, split);
+                }
+
+                uint16_t address;
+                Debugger::Condition condition = {};
+
+                if (Debugger::ParseAddress(text, address) && (condition_text.empty() || Debugger::ParseCondition(condition_text, condition))) {
+                    debugger.addBreakpoint(address, condition);
+                    breakpoint_text[0] = 0;
+                }
+            }
+
+            const auto &breakpoints = debugger.breakpointList();
+
+            for (size_t i = 0; i < breakpoints.size(); i++) {
+                const auto &breakpoint = breakpoints[i];
+                bool enabled = breakpoint.enabled;
+
+                ImGui::PushID((int)i);
+                if (ImGui::Checkbox("##Enabled", &enabled))
+                    debugger.enableBreakpoint(i, enabled);
+                ImGui::SameLine();
+                ImGui::Text("$%04X %s (%llu hits)", breakpoint.address, Debugger::FormatCondition(breakpoint.condition).c_str(), (unsigned long long)breakpoint.hits);
+                ImGui::SameLine();
+                bool remove = ImGui::SmallButton("Remove");
+                ImGui::PopID();
+
+                if (remove) {
+                    debugger.removeBreakpoint(i);
+                    break;
+                }
+            }
+        }
+
+        if (ImGui::CollapsingHeader("Watchpoints", ImGuiTreeNodeFlags_DefaultOpen)) {
+            ImGui::SetNextItemWidth(48);
+            ImGui::InputTextWithHint("##Start", "5000", watch_start_text, sizeof(watch_start_text));
+            ImGui::SameLine();
+            ImGui::SetNextItemWidth(48);
+            ImGui::InputTextWithHint("##End", "5007", watch_end_text, sizeof(watch_end_text));
+            ImGui::SameLine();
+            ImGui::SetNextItemWidth(80);
+            int32_t access = watch_access - 1;
+            if (ImGui::Combo("##Access", &access, "Read\0Write\0Read/Write\0\0"))
+                watch_access = access + 1;
+            ImGui::SameLine();
+            ImGui::SetNextItemWidth(120);
+            ImGui::InputTextWithHint("##Condition", "value & $80", watch_condition_text, sizeof(watch_condition_text));
+            ImGui::SameLine();
+
+            if (ImGui::Button("Add##Watchpoint")) {
+                uint16_t start, end;
+                Debugger::Condition condition = {};
+
+                if (Debugger::ParseAddress(watch_start_text, start) && (!watch_condition_text[0] || Debugger::ParseCondition(watch_condition_text, condition))) {
+                    if (!Debugger::ParseAddress(watch_end_text, end))
+                        end = start;
+
+                    debugger.addWatchpoint(start, end, (Debugger::Access)watch_access, condition);
+                }
+            }
+
+            const auto &watchpoints = debugger.watchpointList();
+
+            for (size_t i = 0; i < watchpoints.size(); i++) {
+                static const char *AccessNames[] = {"", "read", "write", "read/write"};
+                const auto &watchpoint = watchpoints[i];
+                bool enabled = watchpoint.enabled;
+
+                ImGui::PushID((int)i);
+                if (ImGui::Checkbox("##Enabled", &enabled))
+                    debugger.enableWatchpoint(i, enabled);
+                ImGui::SameLine();
+                ImGui::Text("$%04X-$%04X %s %s (%llu hits)", watchpoint.start, watchpoint.end, AccessNames[watchpoint.access], Debugger::FormatCondition(watchpoint.condition).c_str(), (unsigned long long)watchpoint.hits);
+                ImGui::SameLine();
+                bool remove = ImGui::SmallButton("Remove");
+                ImGui::PopID();
+
+                if (remove) {
+                    debugger.removeWatchpoint(i);
+                    break;
+                }
+            }
+        }
+    }
+
+    ImGui::End();
+}
+
+void DebugView::memoryWindow() {
+    ImGui::SetNextWindowSize(ImVec2(560, 400), ImGuiCond_FirstUseEver);
+
+    if (ImGui::Begin("Memory", &show_memory)) {
+        ImGui::SetNextItemWidth(64);
+        if (ImGui::InputTextWithHint("Go to", "0200", memory_goto_text, sizeof(memory_goto_text), ImGuiInputTextFlags_EnterReturnsTrue)) {
+            uint16_t address;
+
+            if (Debugger::ParseAddress(memory_goto_text, address))
+                memory_goto = address >> 4;
+        }
+
+        ImGui::SameLine();
+        ImGui::TextDisabled("Registers read as $FF, reads here have no side effects");
+
+        if (ImGui::BeginChild("##Rows", ImVec2(0, 0), ImGuiChildFlags_Borders)) {
+            float row_height = ImGui::GetTextLineHeightWithSpacing();
+
+            if (memory_goto >= 0) {
+                ImGui::SetScrollY(memory_goto * row_height);
+                memory_goto = -1;
+            }
+
+            // only the visible rows of the 4096 are formatted
+            ImGuiListClipper clipper;
+            clipper.Begin(0x10000 / 16, row_height);
+
+            while (clipper.Step()) {
+                for (int32_t row = clipper.DisplayStart; row < clipper.DisplayEnd; row++) {
+                    static const char HexDigits[] = "0123456789ABCDEF";
+
+                    uint16_t address = row * 16;
+                    char text[80];
+                    char *out = text + snprintf(text, sizeof(text), "%04X: ", address);
+
+                    uint8_t bytes[16];
+                    for (int32_t i = 0; i < 16; i++) {
+                        bytes[i] = gamate.peek(address + i);
+
+                        *out++ = HexDigits[bytes[i] >> 4];
+                        *out++ = HexDigits[bytes[i] & 0x0F];
+                        *out++ = i == 7 ? '-' : ' ';
+                    }
+
+                    *out++ = ' ';
+
+                    for (int32_t i = 0; i < 16; i++)
+                        *out++ = bytes[i] >= 0x20 && bytes[i] < 0x7F ? bytes[i] : '.';
+
+                    *out = 0;
+
+                    ImGui::TextUnformatted(text);
+                }
+            }
+        }
+        ImGui::EndChild();
+    }
+
+    ImGui::End();
+}
+
+void DebugView::vramWindow() {
+    ImGui::SetNextWindowSize(ImVec2(560, 330), ImGuiCond_FirstUseEver);
+
+    if (ImGui::Begin("VRAM", &show_vram)) {
+        if (!planes_loaded) {
+            for (int32_t plane = 0; plane < 2; plane++) {
+                // a plain Image, the raylib-cpp one would free our pixels
+                ::Image image = {plane_pixels[plane].data(), 256, 256, 1, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8};
+                plane_textures[plane].Load(image);
+                // the first compare below must see every row as changed
+                shown_planes[plane] = gamate.lcd.bitPlane(plane);
+                for (auto &byte : shown_planes[plane])
+                    byte = ~byte;
+            }
+
+            planes_loaded = true;
+        }
+
+        for (int32_t plane = 0; plane < 2; plane++) {
+            const auto &bits = gamate.lcd.bitPlane(plane);
+            auto &shown = shown_planes[plane];
+            auto &pixels = plane_pixels[plane];
+
+            // expand and upload only the rows whose 32 bytes changed
+            for (int32_t row = 0; row < 256; row++) {
+                if (std::memcmp(&bits[row * 32], &shown[row * 32], 32) == 0)
+                    continue;
+
+                std::memcpy(&shown[row * 32], &bits[row * 32], 32);
+
+                for (int32_t x = 0; x < 256; x++)
+                    pixels[row * 256 + x] = bits[row * 32 + (x >> 3)] & (0x80 >> (x & 7)) ? PlaneOn : PlaneOff;
+
+                plane_textures[plane].Update(raylib::Rectangle(0, row, 256, 1), &pixels[row * 256]);
+            }
+
+            if (plane)
+                ImGui::SameLine();
+
+            ImGui::BeginGroup();
+            ImGui::Text("Bitplane %d", plane);
+            rlImGuiImage(&plane_textures[plane]);
+            ImGui::EndGroup();
+        }
+    }
+
+    ImGui::End();
+}
+
+void DebugView::registersWindow() {
+    ImGui::SetNextWindowSize(ImVec2(360, 360), ImGuiCond_FirstUseEver);
+
+    if (ImGui::Begin("Registers", &show_registers)) {
+        CPU::State cpu;
+        gamate.cpu.saveState(cpu);
+
+        const RunningState &running_state = gamate.running_state;
+
+        if (ImGui::CollapsingHeader("CPU", ImGuiTreeNodeFlags_DefaultOpen)) {
+            ImGui::Text("PC $%04X  A $%02X  X $%02X  Y $%02X  S $%02X  P $%02X", cpu.PC, cpu.A, cpu.X, cpu.Y, cpu.S, cpu.P);
+            ImGui::Text("Cycles %llu  Instructions %llu", (unsigned long long)gamate.cpu.cycleCount(), (unsigned long long)gamate.cpu.instructionCount());
+            ImGui::Text("Bank 0 $%05X  Bank 1 $%05X", running_state.bank0_offset, running_state.bank1_offset);
+        }
+
+        if (ImGui::CollapsingHeader("LCD", ImGuiTreeNodeFlags_DefaultOpen)) {
+            // saveState copies the planes too, cheap enough for one window
+            static LCD::State lcd;
+            gamate.lcd.saveState(lcd);
+
+            ImGui::Text("VRAM address $%04X  plane %d", lcd.vramAddress, lcd.bitPlaneSelected);
+            ImGui::Text("Scroll X %3d  Y %3d", lcd.xScroll, lcd.yScroll);
+            ImGui::Text("Blank %d  Vertical %d  Swap %d  Window %d  No refresh %d", lcd.displayBlank, lcd.incrementVertical, lcd.swapBitPlanes, lcd.windowMode, lcd.noRefresh);
+        }
+
+        if (ImGui::CollapsingHeader("PSG", ImGuiTreeNodeFlags_DefaultOpen)) {
+            for (int32_t reg = 0; reg < 16; reg++) {
+                if (reg % 8)
+                    ImGui::SameLine();
+
+                ImGui::Text("%X:%02X", reg, gamate.psg.reg[reg]);
+            }
+        }
+    }
+
+    ImGui::End();
+}
+
+DebugView::~DebugView() {
+
+}
@@ -0,0 +1,84 @@
+/******************************************************************************
+
+Copyright (C) 2025 Neil Richardson (nrich@neiltopia.com)
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, version 3.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+
+******************************************************************************/
+
+
+#ifndef DEBUGVIEW_H
+#define DEBUGVIEW_H
+
+#include <cstdint>
+#include <array>
+#include <vector>
+
+#include <raylib-cpp.hpp>
+
+#include "Debugger.h"
+#include "DisassemblyCache.h"
+#include "Gamate.h"
+
+/*
+    ImGui debugger windows: execution controls with breakpoints and a
+    disassembly around PC, a memory viewer, the two VRAM bitplanes and the
+    CPU, LCD and PSG registers. Hidden windows cost nothing and the
+    debugger is only attached while its window is open or breakpoints are
+    set. Shown windows only redo what changed: disassembly comes from a
+    bank aware cache, the memory viewer draws visible rows and VRAM rows
+    are re-expanded only when their bytes differ.
+*/
+class DebugView {
+    Gamate &gamate;
+    Debugger &debugger;
+
+    bool show_debugger = false;
+    bool show_memory = false;
+    bool show_vram = false;
+    bool show_registers = false;
+
+    DisassemblyCache disassembly;
+    std::vector<DisassemblyCache::Line> lines;
+
+    char breakpoint_text[64] = "";
+    char watch_start_text[8] = "";
+    char watch_end_text[8] = "";
+    char watch_condition_text[64] = "";
+    int32_t watch_access = Debugger::Write;
+
+    char memory_goto_text[8] = "";
+    int32_t memory_goto = -1;
+
+    std::array<std::array<uint8_t, 0x2000>, 2> shown_planes;
+    std::array<std::vector<uint32_t>, 2> plane_pixels;
+    std::array<raylib::TextureUnmanaged, 2> plane_textures;
+    bool planes_loaded = false;
+
+    void controls(RunningState &running_state);
+    void debuggerWindow(RunningState &running_state);
+    void memoryWindow();
+    void vramWindow();
+    void registersWindow();
+public:
+    DebugView(Gamate &gamate, Debugger &debugger);
+
+    // items for the Debug menu
+    void menu();
+
+    void draw();
+
+    ~DebugView();
+};
+
+#endif //DEBUGVIEW_H
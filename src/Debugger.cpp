@@ -0,0 +1,484 @@
+/******************************************************************************
+
+Copyright (C) 2025 Neil Richardson (nrich@neiltopia.com)
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, version 3.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+
+******************************************************************************/
+
+
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+#include "Debugger.h"
+
+void Debugger::attach(Gamate &target) {
+    if (gamate)
+        detach();
+
+    gamate = &target;
+    gamate->cpu.setBreakCheck([this](uint16_t pc) { return check(pc); });
+
+    resuming = gamate->cpu.stopped();
+    rebuild();
+}
+
+void Debugger::detach() {
+    if (!gamate)
+        return;
+
+    gamate->cpu.setBreakCheck(nullptr);
+    gamate->setBusHook(nullptr);
+    gamate = nullptr;
+
+    pending = Stop();
+}
+
+void Debugger::rebuild() {
+    breakpoint_bits.fill(0);
+    read_pages.fill(0);
+    write_pages.fill(0);
+
+    for (const auto &breakpoint : breakpoints) {
+        if (breakpoint.enabled)
+            breakpoint_bits[breakpoint.address >> 6] |= 1ULL << (breakpoint.address & 63);
+    }
+
+    bool watching = false;
+
+    for (const auto &watchpoint : watchpoints) {
+        if (!watchpoint.enabled)
+            continue;
+
+        for (uint32_t page = watchpoint.start >> 8; page <= (uint32_t)(watchpoint.end >> 8); page++) {
+            if (watchpoint.access & Read)
+                read_pages[page >> 6] |= 1ULL << (page & 63);
+            if (watchpoint.access & Write)
+                write_pages[page >> 6] |= 1ULL << (page & 63);
+        }
+
+        watching = true;
+    }
+
+    // only pay for checked bus accesses while something is watched
+    if (gamate) {
+        if (watching)
+            gamate->setBusHook([this](uint16_t address, uint8_t value, bool write) { access(address, value, write); });
+        else
+            gamate->setBusHook(nullptr);
+    }
+}
+
+bool Debugger::check(uint16_t pc) {
+    if (resuming) {
+        // the instruction stopped at runs once before anything can break again
+        resuming = false;
+
+        if (step_budget > 0)
+            step_budget--;
+
+        return false;
+    }
+
+    if (pause_requested) {
+        Stop paused;
+        paused.reason = PauseRequest;
+        paused.pc = pc;
+
+        return stop(paused);
+    }
+
+    if (pending.reason != NoStop) {
+        Stop hit = pending;
+        hit.pc = pc;
+        pending = Stop();
+
+        return stop(hit);
+    }
+
+    if (step_budget == 0) {
+        Stop stepped;
+        stepped.reason = StepDone;
+        stepped.pc = pc;
+
+        return stop(stepped);
+    }
+
+    if (step_budget > 0)
+        step_budget--;
+
+    if (breakpoint_bits[pc >> 6] & (1ULL << (pc & 63))) {
+        for (size_t i = 0; i < breakpoints.size(); i++) {
+            Breakpoint &breakpoint = breakpoints[i];
+
+            if (!breakpoint.enabled || breakpoint.address != pc || !test(breakpoint.condition, 0))
+                continue;
+
+            breakpoint.hits++;
+
+            Stop hit;
+            hit.reason = BreakpointHit;
+            hit.index = i;
+            hit.pc = pc;
+
+            return stop(hit);
+        }
+    }
+
+    return false;
+}
+
+void Debugger::access(uint16_t address, uint8_t value, bool write) {
+    uint8_t page = address >> 8;
+    const auto &pages = write ? write_pages : read_pages;
+
+    if (!(pages[page >> 6] & (1ULL << (page & 63))))
+        return;
+
+    for (size_t i = 0; i < watchpoints.size(); i++) {
+        Watchpoint &watchpoint = watchpoints[i];
+
+        if (!watchpoint.enabled || !(watchpoint.access & (write ? Write : Read)))
+            continue;
+
+        if (address < watchpoint.start || address > watchpoint.end || !test(watchpoint.condition, value))
+            continue;
+
+        watchpoint.hits++;
+
+        // the CPU stops before the next instruction, keep the first hit
+        if (pending.reason == NoStop) {
+            pending.reason = WatchpointHit;
+            pending.index = i;
+            pending.address = address;
+            pending.value = value;
+            pending.write = write;
+        }
+
+        return;
+    }
+}
+
+bool Debugger::test(const Condition &condition, uint8_t value) const {
+    if (!condition.active)
+        return true;
+
+    CPU::State state;
+    gamate->cpu.saveState(state);
+
+    uint16_t operand = 0;
+
+    switch (condition.operand) {
+        case RegisterA:
+            operand = state.A;
+            break;
+        case RegisterX:
+            operand = state.X;
+            break;
+        case RegisterY:
+            operand = state.Y;
+            break;
+        case RegisterS:
+            operand = state.S;
+            break;
+        case RegisterP:
+            operand = state.P;
+            break;
+        case RegisterPC:
+            operand = state.PC;
+            break;
+        case AccessValue:
+            operand = value;
+            break;
+        case Memory:
+            operand = gamate->peek(condition.address);
+            break;
+    }
+
+    switch (condition.compare) {
+        case Equal:
+            return operand == condition.value;
+        case NotEqual:
+            return operand != condition.value;
+        case Less:
+            return operand < condition.value;
+        case LessEqual:
+            return operand <= condition.value;
+        case Greater:
+            return operand > condition.value;
+        case GreaterEqual:
+            return operand >= condition.value;
+        case AnyBits:
+            return (operand & condition.value) != 0;
+    }
+
+    return false;
+}
+
+bool Debugger::stop(const Stop &reason) {
+    last_stop = reason;
+
+    resuming = true;
+    pause_requested = false;
+    step_budget = -1;
+
+    return true;
+}
+
+size_t Debugger::addBreakpoint(uint16_t address, const Condition &condition) {
+    breakpoints.push_back({address, true, condition, 0});
+    rebuild();
+
+    return breakpoints.size() - 1;
+}
+
+void Debugger::removeBreakpoint(size_t index) {
+    if (index >= breakpoints.size())
+        return;
+
+    breakpoints.erase(breakpoints.begin() + index);
+    rebuild();
+}
+
+void Debugger::enableBreakpoint(size_t index, bool enabled) {
+    if (index >= breakpoints.size())
+        return;
+
+    breakpoints[index].enabled = enabled;
+    rebuild();
+}
+
+size_t Debugger::addWatchpoint(uint16_t start, uint16_t end, Access access, const Condition &condition) {
+    if (end < start)
+        std::swap(start, end);
+
+    watchpoints.push_back({start, end, access, true, condition, 0});
+    rebuild();
+
+    return watchpoints.size() - 1;
+}
+
+void Debugger::removeWatchpoint(size_t index) {
+    if (index >= watchpoints.size())
+        return;
+
+    watchpoints.erase(watchpoints.begin() + index);
+    rebuild();
+}
+
+void Debugger::enableWatchpoint(size_t index, bool enabled) {
+    if (index >= watchpoints.size())
+        return;
+
+    watchpoints[index].enabled = enabled;
+    rebuild();
+}
+
+void Debugger::pause() {
+    pause_requested = true;
+}
+
+void Debugger::step(uint32_t count) {
+    pause_requested = false;
+    step_budget = count;
+}
+
+void Debugger::resume() {
+    pause_requested = false;
+    step_budget = -1;
+}
+
+static bool parse_number(const char *&text, uint16_t &value) {
+    int base = 10;
+
+    if (*text == '$') {
+        base = 16;
+        text++;
+    } else if (text[0] == '0' && (text[1] == 'x' || text[1] == 'X')) {
+        base = 16;
+        text += 2;
+    }
+
+    char *end = nullptr;
+    unsigned long parsed = std::strtoul(text, &end, base);
+
+    if (end == text || parsed > 0xFFFF)
+        return false;
+
+    value = (uint16_t)parsed;
+    text = end;
+
+    return true;
+}
+
+static bool match_name(const char *text, const char *name) {
+    for (; *name; text++, name++) {
+        if (std::toupper((unsigned char)*text) != std::toupper((unsigned char)*name))
+            return false;
+    }
+
+    return !std::isalnum((unsigned char)*text);
+}
+
+static void skip_spaces(const char *&text) {
+    while (std::isspace((unsigned char)*text))
+        text++;
+}
+
+bool Debugger::ParseAddress(const std::string &text, uint16_t &address) {
+    const char *start = text.c_str();
+
+    if (*start == '$')
+        start++;
+
+    char *end = nullptr;
+    unsigned long value = std::strtoul(start, &end, 16);
+
+    if (end == start || *end || value > 0xFFFF)
+        return false;
+
+    address = (uint16_t)value;
+
+    return true;
+}
+
+bool Debugger::ParseCondition(const std::string &text, Condition &condition) {
+    static const struct {
+        const char *name;
+        Operand operand;
+    } Operands[] = {
+        {"PC", RegisterPC}, {"A", RegisterA}, {"X", RegisterX}, {"Y", RegisterY}, {"S", RegisterS}, {"P", RegisterP}, {"value", AccessValue},
+    };
+
+    static const struct {
+        const char *symbol;
+        Compare compare;
+    } Compares[] = {
+        {"==", Equal}, {"!=", NotEqual}, {"<=", LessEqual}, {">=", GreaterEqual}, {"<", Less}, {">", Greater}, {"&", AnyBits},
+    };
+
+    Condition parsed = {};
+    parsed.active = true;
+
+    const char *p = text.c_str();
+    skip_spaces(p);
+
+    if (*p == '[') {
+        p++;
+        skip_spaces(p);
+
+        if (!parse_number(p, parsed.address))
+            return false;
+
+        skip_spaces(p);
+
+        if (*p++ != ']')
+            return false;
+
+        parsed.operand = Memory;
+    } else {
+        bool found = false;
+
+        for (const auto &operand : Operands) {
+            if (match_name(p, operand.name)) {
+                parsed.operand = operand.operand;
+                p += std::char_traits<char>::length(operand.name);
+                found = true;
+                break;
+            }
+        }
+
+        if (!found)
+            return false;
+    }
+
+    skip_spaces(p);
+
+    bool found = false;
+
+    for (const auto &compare : Compares) {
+        size_t length = std::char_traits<char>::length(compare.symbol);
+
+        if (std::char_traits<char>::compare(p, compare.symbol, length) == 0) {
+            parsed.compare = compare.compare;
+            p += length;
+            found = true;
+            break;
+        }
+    }
+
+    if (!found)
+        return false;
+
+    skip_spaces(p);
+
+    if (!parse_number(p, parsed.value))
+        return false;
+
+    skip_spaces(p);
+
+    if (*p)
+        return false;
+
+    condition = parsed;
+
+    return true;
+}
+
+std::string Debugger::FormatCondition(const Condition &condition) {
+    static const char *OperandNames[] = {"A", "X", "Y", "S", "P", "PC", "value", ""};
+    static const char *CompareSymbols[] = {"==", "!=", "<", "<=", ">", ">=", "&"};
+
+    if (!condition.active)
+        return "";
+
+    char text[48];
+
+    if (condition.operand == Memory)
+        snprintf(text, sizeof(text), "[$%04X] %s $%02X", condition.address, CompareSymbols[condition.compare], condition.value);
+    else if (condition.operand == RegisterPC)
+        snprintf(text, sizeof(text), "PC %s $%04X", CompareSymbols[condition.compare], condition.value);
+    else
+        snprintf(text, sizeof(text), "%s %s $%02X", OperandNames[condition.operand], CompareSymbols[condition.compare], condition.value);
+
+    return text;
+}
+
+std::string Debugger::FormatStop(const Stop &stop) {
+    char text[80];
+
+    switch (stop.reason) {
+        case PauseRequest:
+            snprintf(text, sizeof(text), "Paused at $%04X", stop.pc);
+            break;
+        case StepDone:
+            snprintf(text, sizeof(text), "Stepped to $%04X", stop.pc);
+            break;
+        case BreakpointHit:
+            snprintf(text, sizeof(text), "Breakpoint %zu at $%04X", stop.index, stop.pc);
+            break;
+        case WatchpointHit:
+            snprintf(text, sizeof(text), "Watchpoint %zu: %s $%02X %s $%04X, stopped at $%04X", stop.index, stop.write ? "wrote" : "read", stop.value, stop.write ? "to" : "from", stop.address, stop.pc);
+            break;
+        default:
+            snprintf(text, sizeof(text), "Running");
+    }
+
+    return text;
+}
+
+Debugger::~Debugger() {
+    detach();
+}
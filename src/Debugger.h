@@ -0,0 +1,191 @@
+/******************************************************************************
+
+Copyright (C) 2025 Neil Richardson (nrich@neiltopia.com)
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, version 3.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+
+******************************************************************************/
+
+
+#ifndef DEBUGGER_H
+#define DEBUGGER_H
+
+#include <cstdint>
+#include <cstddef>
+#include <array>
+#include <string>
+#include <vector>
+
+#include "Gamate.h"
+
+/*
+    Debugger backend: PC breakpoints, read/write watchpoints on address
+    ranges and optional conditions on both. Attaching switches the CPU to
+    its hooked loop and the bus to a checked one, detached the emulator
+    runs without any per-instruction or per-access checks. Breakpoints
+    and watched pages are kept in bitmaps so each check is one bit test
+    however many ranges are set.
+*/
+class Debugger {
+public:
+    enum Access : uint8_t {
+        Read = 1,
+        Write = 2,
+        ReadWrite = 3,
+    };
+
+    enum Operand : uint8_t {
+        RegisterA,
+        RegisterX,
+        RegisterY,
+        RegisterS,
+        RegisterP,
+        RegisterPC,
+        AccessValue, // value read or written, for watchpoints
+        Memory,
+    };
+
+    enum Compare : uint8_t {
+        Equal,
+        NotEqual,
+        Less,
+        LessEqual,
+        Greater,
+        GreaterEqual,
+        AnyBits, // operand & value != 0
+    };
+
+    // zero initialised is "always true"
+    struct Condition {
+        bool active;
+        Operand operand;
+        Compare compare;
+        uint16_t address; // for Memory
+        uint16_t value;
+    };
+
+    struct Breakpoint {
+        uint16_t address;
+        bool enabled;
+        Condition condition;
+        uint64_t hits;
+    };
+
+    struct Watchpoint {
+        uint16_t start;
+        uint16_t end; // inclusive
+        Access access;
+        bool enabled;
+        Condition condition;
+        uint64_t hits;
+    };
+
+    enum Reason : uint8_t {
+        NoStop,
+        PauseRequest,
+        StepDone,
+        BreakpointHit,
+        WatchpointHit,
+    };
+
+    struct Stop {
+        Reason reason = NoStop;
+        size_t index = 0; // breakpoint or watchpoint
+        uint16_t pc = 0;
+        uint16_t address = 0; // watched access
+        uint8_t value = 0;
+        bool write = false;
+    };
+private:
+    Gamate *gamate = nullptr;
+
+    std::vector<Breakpoint> breakpoints;
+    std::vector<Watchpoint> watchpoints;
+
+    // one bit per address with a breakpoint, one bit per 256 byte page watched
+    std::array<uint64_t, 65536 / 64> breakpoint_bits = {};
+    std::array<uint64_t, 4> read_pages = {};
+    std::array<uint64_t, 4> write_pages = {};
+
+    bool pause_requested = false;
+    bool resuming = false;
+    int64_t step_budget = -1;
+
+    Stop pending;
+    Stop last_stop;
+
+    void rebuild();
+
+    bool check(uint16_t pc);
+    void access(uint16_t address, uint8_t value, bool write);
+
+    bool test(const Condition &condition, uint8_t value) const;
+    bool stop(const Stop &reason);
+public:
+    Debugger() {
+
+    }
+
+    void attach(Gamate &target);
+    void detach();
+
+    bool attached() const {
+        return gamate != nullptr;
+    }
+
+    size_t addBreakpoint(uint16_t address, const Condition &condition = {});
+    void removeBreakpoint(size_t index);
+    void enableBreakpoint(size_t index, bool enabled);
+
+    const std::vector<Breakpoint> &breakpointList() const {
+        return breakpoints;
+    }
+
+    size_t addWatchpoint(uint16_t start, uint16_t end, Access access, const Condition &condition = {});
+    void removeWatchpoint(size_t index);
+    void enableWatchpoint(size_t index, bool enabled);
+
+    const std::vector<Watchpoint> &watchpointList() const {
+        return watchpoints;
+    }
+
+    // stop before the next instruction
+    void pause();
+
+    // run count instructions from where the CPU stopped, then stop again
+    void step(uint32_t count = 1);
+
+    // forget any pause or step request, the instruction stopped at runs
+    // without breaking again when the emulator carries on
+    void resume();
+
+    bool stopped() const {
+        return gamate && gamate->cpu.stopped();
+    }
+
+    const Stop &lastStop() const {
+        return last_stop;
+    }
+
+    // hex, with or without a leading $
+    static bool ParseAddress(const std::string &text, uint16_t &address);
+
+    // parses "A == $10", "[$0200] & $80", "value != 0", "PC >= $A000"
+    static bool ParseCondition(const std::string &text, Condition &condition);
+    static std::string FormatCondition(const Condition &condition);
+    static std::string FormatStop(const Stop &stop);
+
+    ~Debugger();
+};
+
+#endif //DEBUGGER_H
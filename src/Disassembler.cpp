@@ -0,0 +1,154 @@
+/******************************************************************************
+
+Copyright (C) 2025 Neil Richardson (nrich@neiltopia.com)
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, version 3.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+
+******************************************************************************/
+
+
+#include "Disassembler.h"
+#include "Opcodes.h"
+
+static const char HexDigits[] = "0123456789ABCDEF";
+
+static inline char *put_byte(char *out, uint8_t value) {
+    *out++ = '$';
+    *out++ = HexDigits[value >> 4];
+    *out++ = HexDigits[value & 0x0F];
+
+    return out;
+}
+
+static inline char *put_word(char *out, uint16_t value) {
+    *out++ = '$';
+    *out++ = HexDigits[value >> 12];
+    *out++ = HexDigits[(value >> 8) & 0x0F];
+    *out++ = HexDigits[(value >> 4) & 0x0F];
+    *out++ = HexDigits[value & 0x0F];
+
+    return out;
+}
+
+static inline char *put_text(char *out, const char *text) {
+    while (*text)
+        *out++ = *text++;
+
+    return out;
+}
+
+int32_t Disassembler::Format(const uint8_t *bytes, uint16_t address, char *text) {
+    const OpcodeInfo &op = Opcodes[bytes[0]];
+    uint8_t lo = bytes[1];
+    uint16_t word = bytes[1] | (bytes[2] << 8);
+
+    char *out = text;
+
+    if (op.mode == AddressMode::Invalid) {
+        out = put_text(out, ".db ");
+        out = put_byte(out, bytes[0]);
+        *out = 0;
+
+        return op.length;
+    }
+
+    out = put_text(out, op.mnemonic);
+
+    switch (op.mode) {
+        case AddressMode::Accumulator:
+            out = put_text(out, " A");
+            break;
+        case AddressMode::Immediate:
+            out = put_text(out, " #");
+            out = put_byte(out, lo);
+            break;
+        case AddressMode::ZeroPage:
+            *out++ = ' ';
+            out = put_byte(out, lo);
+            break;
+        case AddressMode::ZeroPageX:
+            *out++ = ' ';
+            out = put_byte(out, lo);
+            out = put_text(out, ",X");
+            break;
+        case AddressMode::ZeroPageY:
+            *out++ = ' ';
+            out = put_byte(out, lo);
+            out = put_text(out, ",Y");
+            break;
+        case AddressMode::Absolute:
+            *out++ = ' ';
+            out = put_word(out, word);
+            break;
+        case AddressMode::AbsoluteX:
+            *out++ = ' ';
+            out = put_word(out, word);
+            out = put_text(out, ",X");
+            break;
+        case AddressMode::AbsoluteY:
+            *out++ = ' ';
+            out = put_word(out, word);
+            out = put_text(out, ",Y");
+            break;
+        case AddressMode::Indirect:
+            out = put_text(out, " (");
+            out = put_word(out, word);
+            *out++ = ')';
+            break;
+        case AddressMode::IndirectX:
+            out = put_text(out, " (");
+            out = put_byte(out, lo);
+            out = put_text(out, ",X)");
+            break;
+        case AddressMode::IndirectY:
+            out = put_text(out, " (");
+            out = put_byte(out, lo);
+            out = put_text(out, "),Y");
+            break;
+        case AddressMode::IndirectZeroPage:
+            out = put_text(out, " (");
+            out = put_byte(out, lo);
+            *out++ = ')';
+            break;
+        case AddressMode::AbsoluteIndirectX:
+            out = put_text(out, " (");
+            out = put_word(out, word);
+            out = put_text(out, ",X)");
+            break;
+        case AddressMode::Relative:
+            *out++ = ' ';
+            out = put_word(out, address + 2 + (int8_t)lo);
+            break;
+        default:
+            break;
+    }
+
+    *out = 0;
+
+    return op.length;
+}
+
+std::string Disassembler::Disassemble(const std::function<uint8_t(uint16_t)> &peek, uint16_t address, int32_t *length) {
+    uint8_t bytes[3] = {peek(address), 0, 0};
+
+    for (int32_t i = 1; i < Opcodes[bytes[0]].length; i++)
+        bytes[i] = peek(address + i);
+
+    char text[MaxText];
+    int32_t size = Format(bytes, address, text);
+
+    if (length)
+        *length = size;
+
+    return text;
+}
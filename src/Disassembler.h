@@ -0,0 +1,46 @@
+/******************************************************************************
+
+Copyright (C) 2025 Neil Richardson (nrich@neiltopia.com)
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, version 3.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+
+******************************************************************************/
+
+
+#ifndef DISASSEMBLER_H
+#define DISASSEMBLER_H
+
+#include <cstdint>
+#include <cstddef>
+#include <functional>
+#include <string>
+
+/*
+    Table driven 65C02 disassembler over the shared Opcodes metadata.
+    Format() writes straight into a caller buffer without printf, so bulk
+    decoding (trace dumps, ROM listings) stays cheap.
+*/
+class Disassembler {
+public:
+    // enough for the longest instruction text plus the terminator
+    static const size_t MaxText = 16;
+
+    // decodes the instruction in bytes[0..2] located at address into text,
+    // returns its length in bytes
+    static int32_t Format(const uint8_t *bytes, uint16_t address, char *text);
+
+    // disassembles the instruction at address, reading memory through peek
+    static std::string Disassemble(const std::function<uint8_t(uint16_t)> &peek, uint16_t address, int32_t *length = nullptr);
+};
+
+#endif //DISASSEMBLER_H
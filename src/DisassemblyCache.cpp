@@ -0,0 +1,133 @@
+/******************************************************************************
+
+Copyright (C) 2025 Neil Richardson (nrich@neiltopia.com)
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, version 3.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+
+******************************************************************************/
+
+
+#include <algorithm>
+
+#include "DisassemblyCache.h"
+#include "Opcodes.h"
+
+DisassemblyCache::DisassemblyCache() {
+    windows[0].start = 0x6000;
+    windows[0].size = 0x4000;
+    windows[1].start = 0xA000;
+    windows[1].size = 0x4000;
+    windows[2].start = 0xE000;
+    windows[2].size = 0x2000;
+}
+
+DisassemblyCache::Line DisassemblyCache::Decode(const Gamate &gamate, uint16_t address) {
+    Line line;
+
+    line.address = address;
+    line.bytes[0] = gamate.peek(address);
+    line.bytes[1] = gamate.peek(address + 1);
+    line.bytes[2] = gamate.peek(address + 2);
+    line.length = Disassembler::Format(line.bytes, address, line.text);
+
+    return line;
+}
+
+DisassemblyCache::Window *DisassemblyCache::lookup(const Gamate &gamate, uint16_t address) {
+    Window *window;
+    const SharedImage *image;
+    uint32_t key;
+
+    if (address >= 0x6000 && address <= 0x9FFF) {
+        window = &windows[0];
+        image = gamate.romImage().get();
+        key = gamate.running_state.bank0_offset;
+    } else if (address >= 0xA000 && address <= 0xDFFF) {
+        window = &windows[1];
+        image = gamate.romImage().get();
+        key = gamate.running_state.bank1_offset;
+    } else if (address >= 0xE000) {
+        window = &windows[2];
+        image = gamate.biosImage().get();
+        key = gamate.biosVersion();
+    } else {
+        return nullptr;
+    }
+
+    uint32_t image_crc = image ? image->crc() : 0;
+
+    if (window->valid && window->image_crc == image_crc && window->key == key)
+        return window;
+
+    window->lines.clear();
+
+    for (uint32_t offset = 0; offset < window->size;) {
+        Line line = Decode(gamate, window->start + offset);
+
+        window->lines.push_back(line);
+        offset += line.length;
+    }
+
+    window->image_crc = image_crc;
+    window->key = key;
+    window->valid = true;
+
+    sweeps++;
+
+    return window;
+}
+
+void DisassemblyCache::around(const Gamate &gamate, uint16_t address, size_t before, size_t after, std::vector<Line> &out) {
+    out.clear();
+
+    Window *window = lookup(gamate, address);
+
+    if (!window) {
+        for (size_t i = 0; i <= after; i++) {
+            out.push_back(Decode(gamate, address));
+            address += out.back().length;
+        }
+
+        return;
+    }
+
+    const auto &lines = window->lines;
+
+    auto found = std::upper_bound(lines.begin(), lines.end(), address, [](uint16_t value, const Line &line) {
+        return value < line.address;
+    });
+
+    // the sweep may not line up with address when code jumps into the
+    // middle of what it decoded, then only the lines before come from it
+    size_t index = found - lines.begin();
+    bool aligned = index > 0 && lines[index - 1].address == address;
+    size_t end = aligned ? index - 1 : index;
+    size_t first = end > before ? end - before : 0;
+
+    out.insert(out.end(), lines.begin() + first, lines.begin() + end);
+
+    if (aligned) {
+        out.insert(out.end(), lines.begin() + end, lines.begin() + std::min(lines.size(), end + after + 1));
+        return;
+    }
+
+    for (size_t i = 0; i <= after; i++) {
+        out.push_back(Decode(gamate, address));
+        address += out.back().length;
+    }
+}
+
+void DisassemblyCache::invalidate() {
+    for (auto &window : windows)
+        window.valid = false;
+}
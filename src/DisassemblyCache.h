@@ -0,0 +1,77 @@
+/******************************************************************************
+
+Copyright (C) 2025 Neil Richardson (nrich@neiltopia.com)
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, version 3.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+
+******************************************************************************/
+
+
+#ifndef DISASSEMBLYCACHE_H
+#define DISASSEMBLYCACHE_H
+
+#include <cstdint>
+#include <cstddef>
+#include <array>
+#include <vector>
+
+#include "Disassembler.h"
+#include "Gamate.h"
+
+/*
+    Decoded listings of the two cartridge windows and the BIOS for the
+    debugger. Each window is swept once and kept until its bank offset,
+    the ROM or the BIOS contents change, so redrawing every frame costs a
+    lookup. Anything outside them (RAM mostly) is decoded on demand.
+*/
+class DisassemblyCache {
+public:
+    struct Line {
+        uint16_t address;
+        uint8_t length;
+        uint8_t bytes[3];
+        char text[Disassembler::MaxText];
+    };
+private:
+    struct Window {
+        uint16_t start;
+        uint32_t size;
+        uint32_t image_crc = 0;
+        uint32_t key = 0;
+        bool valid = false;
+        std::vector<Line> lines;
+    };
+
+    std::array<Window, 3> windows;
+
+    uint64_t sweeps = 0;
+
+    Window *lookup(const Gamate &gamate, uint16_t address);
+public:
+    DisassemblyCache();
+
+    static Line Decode(const Gamate &gamate, uint16_t address);
+
+    // up to before lines preceding address, then the line at address and
+    // after more
+    void around(const Gamate &gamate, uint16_t address, size_t before, size_t after, std::vector<Line> &out);
+
+    // forget everything, e.g. after loading a different ROM
+    void invalidate();
+
+    uint64_t sweepCount() const {
+        return sweeps;
+    }
+};
+
+#endif //DISASSEMBLYCACHE_H
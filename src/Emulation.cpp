@@ -17,15 +17,40 @@ this program. If not, see <https://www.gnu.org/licenses/>.
 ******************************************************************************/
 
 
-#include <algorithm>
-#include <cstring>
-#include <filesystem>
-#include <fstream>
-
-#include <miniz.h>
+#include <cstdlib>
+#include <ctime>
 
 #include "Emulation.h"
 
+std::string Emulator::capturePath(const std::string &extension) const {
+    char stamp[32];
+    std::time_t now = std::time(nullptr);
+    std::strftime(stamp, sizeof(stamp), "-%Y%m%d-%H%M%S", std::localtime(&now));
+
+    std::filesystem::path path = rom.length() ? std::filesystem::path(rom).replace_extension() : std::filesystem::path("megata");
+    path += stamp;
+    path += extension;
+
+    return path.string();
+}
+
+std::filesystem::path cache_directory() {
+#ifdef _WIN64
+    const char *base = std::getenv("LOCALAPPDATA");
+    if (base && *base)
+        return std::filesystem::path(base) / "megata" / "cache";
+#else
+    const char *base = std::getenv("XDG_CACHE_HOME");
+    if (base && *base)
+        return std::filesystem::path(base) / "megata";
+
+    const char *home = std::getenv("HOME");
+    if (home && *home)
+        return std::filesystem::path(home) / ".cache" / "megata";
+#endif
+    return std::filesystem::path();
+}
+
 RunningState::RunningState() {
     reset();
 }
@@ -43,68 +68,8 @@ void RunningState::reset(bool is_paused, bool is_audio_enabled) {
 
     paused = is_paused;
     audio_enabled = is_audio_enabled;
+    run_ahead = false;
+    fast_forward = false;
+    background = false;
+    speed = 1.0f;
 }
-
-bool load_file(const std::string &filename, uint8_t *data, size_t size) {
-    std::string lc_filename = filename;
-
-    std::transform(lc_filename.begin(), lc_filename.end(), lc_filename.begin(), (int(*)(int)) tolower);
-
-    std::string extension = lc_filename.substr(lc_filename.find_last_of(".") + 1);
-
-    if (extension == "zip") {
-        mz_zip_archive zip_archive = {0};
-
-        if (!mz_zip_reader_init_file(&zip_archive, filename.c_str(), 0))
-            return false;
-
-        for (uint32_t i = 0; i < mz_zip_reader_get_num_files(&zip_archive); i++) {
-            mz_zip_archive_file_stat file_stat;
-
-            if (!mz_zip_reader_file_stat(&zip_archive, i, &file_stat)) {
-                mz_zip_reader_end(&zip_archive);
-                return false;
-            }
-
-            std::string lc_filename((const char*) file_stat.m_filename);
-            std::transform(lc_filename.begin(), lc_filename.end(), lc_filename.begin(), (int(*)(int)) tolower);
-            std::string extension = lc_filename.substr(lc_filename.find_last_of(".") + 1);
-
-            if (extension == "bin") {
-                void *buffer;
-                size_t uncomp_size;
-
-                buffer = mz_zip_reader_extract_file_to_heap(&zip_archive, file_stat.m_filename, &uncomp_size, 0);
-                if (!buffer) {
-                    mz_zip_reader_end(&zip_archive);
-                    return false;
-                }
-
-                bool success = false;
-                if (uncomp_size <= size) {
-                    std::memcpy(data, buffer, uncomp_size);
-                    success = true;
-                }
-
-                mz_zip_reader_end(&zip_archive);
-                free(buffer);
-
-                return success;
-            }
-        }
-
-        mz_zip_reader_end(&zip_archive);
-        return false;
-    } else {
-        std::filesystem::path file_path = filename;
-
-        if (std::filesystem::file_size(file_path) <= size) {
-            std::ifstream fh(filename, std::ios::binary|std::ios::in);
-            fh.read(reinterpret_cast<char*>(data), size);
-            return true;
-        }
-    }
-
-    return false;
-}
-
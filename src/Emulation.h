@@ -22,11 +22,16 @@ this program. If not, see <https://www.gnu.org/licenses/>.
 #include <cstdint>
 #include <array>
 #include <string>
+#include <filesystem>
 
 #include <raylib-cpp.hpp>
 
 typedef std::array<uint32_t, 4> Palette;
 
+// Gamate::runFrame() gives each frame 32768 + 7364 + 25404 CPU cycles, ~67.6 frames a second
+const int32_t CPUClock = 4433000;
+const int32_t FrameCycles = 65536;
+
 struct RunningState {
     std::array<uint8_t, 1024> RAM;
     uint8_t button_state;
@@ -35,6 +40,10 @@ struct RunningState {
     uint32_t bank1_offset;
     bool paused;
     bool audio_enabled;
+    bool run_ahead;
+    bool fast_forward;
+    bool background;
+    float speed;
 
     RunningState();
 
@@ -45,6 +54,10 @@ struct RunningState {
 
 struct Emulator {
     int32_t scale;
+    int32_t run_ahead;
+    bool fast_forward = false;
+    bool pause_unfocused = true;
+    bool show_perf = false;
     std::string rom;
     std::string bios;
     Palette palette;
@@ -52,6 +65,17 @@ struct Emulator {
     bool ready() {
         return rom.length() && bios.length();
     }
+
+    std::string statePath() const {
+        return std::filesystem::path(rom).replace_extension(".sav").string();
+    }
+
+    std::string cheatPath() const {
+        return std::filesystem::path(rom).replace_extension(".cht").string();
+    }
+
+    // timestamped file next to the ROM
+    std::string capturePath(const std::string &extension) const;
 };
 
 struct KeyboardInput {
@@ -64,6 +88,9 @@ struct KeyboardInput {
     int32_t b = KEY_S;
     int32_t start = KEY_ENTER;
     int32_t select = KEY_SPACE;
+
+    int32_t rewind = KEY_BACKSPACE;
+    int32_t fast_forward = KEY_TAB;
 };
 
 struct GamepadInput {
@@ -80,7 +107,8 @@ struct GamepadInput {
     int32_t select = GAMEPAD_BUTTON_MIDDLE_LEFT;
 };
 
+// per user directory for generated files, empty if there is none
+std::filesystem::path cache_directory();
 
-bool load_file(const std::string &filename, uint8_t *data, size_t size);
 
 #endif //EMULATION_H
@@ -0,0 +1,223 @@
+/******************************************************************************
+
+Copyright (C) 2025 Neil Richardson (nrich@neiltopia.com)
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, version 3.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+
+******************************************************************************/
+
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <thread>
+#include <type_traits>
+
+#ifndef _WIN64
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#include "Explorer.h"
+#include "SaveState.h"
+#include "StateHash.h"
+#include "ThreadPool.h"
+
+static_assert(std::is_trivially_copyable<Explorer::Result>::value, "Explorer::Result is written across processes");
+
+Explorer::Explorer(size_t jobs) : jobs(jobs ? jobs : std::max<size_t>(1, std::thread::hardware_concurrency())) {
+
+}
+
+bool Explorer::ForkSupported() {
+#ifdef _WIN64
+    return false;
+#else
+    return true;
+#endif
+}
+
+void Explorer::Explore(Gamate &gamate, const Sequence &sequence, Result &result) {
+    for (uint8_t buttons : sequence) {
+        // the hardware reads held buttons as 0 bits
+        gamate.running_state.button_state = ~buttons;
+
+        while (!gamate.runFrame()) {
+        }
+    }
+
+    result.hash = StateHash::Full(gamate);
+    result.frames = sequence.size();
+    result.RAM = gamate.running_state.RAM;
+    result.done = true;
+}
+
+bool Explorer::run(Gamate &branch, const std::vector<Sequence> &sequences, Mode mode) {
+    results.assign(sequences.size(), Result{});
+
+    auto start = std::chrono::steady_clock::now();
+    bool ok = mode == Fork ? runFork(branch, sequences) : runSnapshot(branch, sequences);
+    elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    return ok;
+}
+
+bool Explorer::runSnapshot(Gamate &branch, const std::vector<Sequence> &sequences) {
+    SaveState state;
+    state.capture(branch);
+
+    // a console per worker, block b runs every blocks-th sequence from b
+    size_t blocks = std::min(jobs, std::max<size_t>(sequences.size(), 1));
+    std::vector<std::unique_ptr<Gamate>> consoles(blocks);
+    ThreadPool pool(blocks);
+
+    pool.run(blocks, [&](size_t block) {
+        consoles[block] = std::make_unique<Gamate>();
+        Gamate &gamate = *consoles[block];
+
+        gamate.setROM(branch.romImage());
+        gamate.setBIOS(branch.biosImage());
+
+        for (size_t i = block; i < sequences.size(); i += blocks) {
+            state.restore(gamate);
+            Explore(gamate, sequences[i], results[i]);
+        }
+    });
+
+    return true;
+}
+
+#ifdef _WIN64
+bool Explorer::runFork(Gamate &branch, const std::vector<Sequence> &sequences) {
+    std::cerr << "Could not fork, not supported on Windows\n";
+    return false;
+}
+#else
+bool Explorer::runFork(Gamate &branch, const std::vector<Sequence> &sequences) {
+    if (sequences.empty())
+        return true;
+
+    size_t bytes = sizeof(Result) * sequences.size();
+    void *mapping = mmap(nullptr, bytes, PROT_READ|PROT_WRITE, MAP_SHARED|MAP_ANONYMOUS, -1, 0);
+
+    if (mapping == MAP_FAILED) {
+        std::cerr << "Could not map " << bytes << " bytes for fork results\n";
+        return false;
+    }
+
+    // anonymous mappings start zeroed, so done is false until a child finishes
+    Result *table = static_cast<Result *>(mapping);
+
+    // children must not flush the parent's buffered output a second time
+    std::cout.flush();
+    std::cerr.flush();
+
+    size_t next = 0;
+    size_t running = 0;
+    bool ok = true;
+
+    while (next < sequences.size() || running) {
+        while (ok && running < jobs && next < sequences.size()) {
+            pid_t pid = fork();
+
+            if (pid == 0) {
+                Explore(branch, sequences[next], table[next]);
+                _exit(0);
+            }
+
+            if (pid < 0) {
+                std::cerr << "Could not fork: " << strerror(errno) << "\n";
+                ok = false;
+                break;
+            }
+
+            running++;
+            next++;
+        }
+
+        if (!running)
+            break;
+
+        int status;
+        if (wait(&status) > 0)
+            running--;
+        else
+            break;
+    }
+
+    for (size_t i = 0; i < sequences.size(); i++) {
+        results[i] = table[i];
+        ok = ok && results[i].done;
+    }
+
+    munmap(mapping, bytes);
+
+    return ok;
+}
+#endif
+
+bool Explorer::LoadSequences(const std::string &filename, std::vector<Sequence> &sequences) {
+    std::ifstream fh(filename);
+
+    if (!fh)
+        return false;
+
+    std::string line;
+
+    while (std::getline(fh, line)) {
+        size_t comment = line.find('#');
+
+        if (comment != std::string::npos)
+            line.erase(comment);
+
+        std::istringstream fields(line);
+        std::string token;
+        Sequence sequence;
+
+        while (fields >> token) {
+            size_t star = token.find('*');
+            char *end = nullptr;
+
+            unsigned long buttons = std::strtoul(token.c_str(), &end, 16);
+            unsigned long count = 1;
+
+            if (star != std::string::npos) {
+                if (end != token.c_str() + star)
+                    return false;
+
+                count = std::strtoul(token.c_str() + star + 1, &end, 10);
+            }
+
+            if (*end || buttons > 0xFF || !count)
+                return false;
+
+            sequence.insert(sequence.end(), count, (uint8_t)buttons);
+        }
+
+        if (!sequence.empty())
+            sequences.push_back(std::move(sequence));
+    }
+
+    return true;
+}
+
+Explorer::~Explorer() {
+
+}
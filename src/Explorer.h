@@ -0,0 +1,99 @@
+/******************************************************************************
+
+Copyright (C) 2025 Neil Richardson (nrich@neiltopia.com)
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, version 3.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+
+******************************************************************************/
+
+
+#ifndef EXPLORER_H
+#define EXPLORER_H
+
+#include <cstdint>
+#include <cstddef>
+#include <array>
+#include <string>
+#include <vector>
+
+#include "Gamate.h"
+
+/*
+    Runs many input sequences from one branch point and collects where
+    each ends up. Snapshot mode saves the branch state once and restores
+    it into a console per worker thread before every sequence. Fork mode
+    (not on Windows) forks a child per sequence, which starts with the
+    branch state, ROM and BIOS shared copy on write and writes its result
+    into a shared memory table, so nothing is copied up front.
+*/
+class Explorer {
+public:
+    enum Mode : uint8_t {
+        Snapshot,
+        Fork,
+    };
+
+    // buttons held per frame, set bits as in the C API
+    typedef std::vector<uint8_t> Sequence;
+
+    // plain data, forked children write these into shared memory
+    struct Result {
+        uint64_t hash; // StateHash::Full of the final state
+        uint32_t frames;
+        bool done;
+        std::array<uint8_t, 1024> RAM;
+    };
+private:
+    size_t jobs;
+
+    std::vector<Result> results;
+    double elapsed = 0;
+
+    static void Explore(Gamate &gamate, const Sequence &sequence, Result &result);
+
+    bool runSnapshot(Gamate &branch, const std::vector<Sequence> &sequences);
+    bool runFork(Gamate &branch, const std::vector<Sequence> &sequences);
+public:
+    // jobs 0 for one per core
+    Explorer(size_t jobs = 0);
+
+    static bool ForkSupported();
+
+    // branch is left as it was
+    bool run(Gamate &branch, const std::vector<Sequence> &sequences, Mode mode);
+
+    const std::vector<Result> &resultList() const {
+        return results;
+    }
+
+    double seconds() const {
+        return elapsed;
+    }
+
+    size_t workers() const {
+        return jobs;
+    }
+
+    /*
+        One sequence per line of hex button masks, BB*N repeats a mask
+        for N frames and # starts a comment:
+
+        # hold right for a second then press A
+        08*68 18 18 08
+    */
+    static bool LoadSequences(const std::string &filename, std::vector<Sequence> &sequences);
+
+    ~Explorer();
+};
+
+#endif //EXPLORER_H
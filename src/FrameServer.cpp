@@ -0,0 +1,158 @@
+/******************************************************************************
+
+Copyright (C) 2025 Neil Richardson (nrich@neiltopia.com)
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, version 3.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+
+******************************************************************************/
+
+
+#include <cstring>
+#include <iostream>
+#include <new>
+
+#ifdef _WIN64
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include "FrameServer.h"
+#include "SharedFrames.h"
+
+FrameServer::FrameServer() {
+
+}
+
+bool FrameServer::open(const std::string &name) {
+    close();
+
+    void *address = nullptr;
+
+#ifdef _WIN64
+    mapping_handle = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, 0, sizeof(SharedFrames), name.c_str());
+
+    if (mapping_handle) {
+        address = MapViewOfFile(mapping_handle, FILE_MAP_ALL_ACCESS, 0, 0, sizeof(SharedFrames));
+
+        if (!address) {
+            CloseHandle(mapping_handle);
+            mapping_handle = nullptr;
+        }
+    }
+#else
+    shm_unlink(name.c_str());
+    int fd = shm_open(name.c_str(), O_RDWR|O_CREAT|O_EXCL, 0600);
+
+    if (fd >= 0) {
+        if (ftruncate(fd, sizeof(SharedFrames)) == 0) {
+            address = mmap(nullptr, sizeof(SharedFrames), PROT_READ|PROT_WRITE, MAP_SHARED, fd, 0);
+
+            if (address == MAP_FAILED)
+                address = nullptr;
+        }
+
+        // the mapping keeps the object alive
+        ::close(fd);
+
+        if (!address)
+            shm_unlink(name.c_str());
+    }
+#endif
+
+    if (!address) {
+        std::cerr << "Could not create shared memory " << name << "\n";
+        return false;
+    }
+
+    // fresh mappings are zeroed, the header goes in last so clients only see a complete layout
+    frames = new (address) SharedFrames;
+
+    for (auto &slot : frames->slots) {
+        slot.frame = UINT64_MAX;
+    }
+
+    frames->slot_count = SharedFrames::SlotCount;
+    frames->slot_size = sizeof(SharedFrames::Slot);
+    frames->version = SharedFrames::Version;
+    std::atomic_thread_fence(std::memory_order_release);
+    frames->magic = SharedFrames::Magic;
+
+    this->name = name;
+    published = 0;
+
+    return true;
+}
+
+void FrameServer::close() {
+    if (!frames)
+        return;
+
+    // tells clients still attached that nothing more is coming
+    frames->magic = 0;
+
+#ifdef _WIN64
+    UnmapViewOfFile(frames);
+    CloseHandle(mapping_handle);
+    mapping_handle = nullptr;
+#else
+    munmap(frames, sizeof(SharedFrames));
+    shm_unlink(name.c_str());
+#endif
+
+    frames = nullptr;
+}
+
+void FrameServer::applyInput(uint8_t &button_state) const {
+    if (frames && frames->control.active.load(std::memory_order_acquire)) {
+        // the hardware reads held buttons as 0 bits
+        button_state = ~frames->control.buttons.load(std::memory_order_relaxed);
+    }
+}
+
+void FrameServer::publish(const Gamate &gamate) {
+    if (!frames)
+        return;
+
+    SharedFrames::Slot &slot = frames->slots[published % SharedFrames::SlotCount];
+    uint32_t sequence = slot.sequence.load(std::memory_order_relaxed);
+
+    slot.sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    slot.buttons = (uint8_t)~gamate.running_state.button_state;
+    slot.frame = published;
+    gamate.lcd.render(slot.shades);
+    std::memcpy(slot.RAM, gamate.running_state.RAM.data(), SharedFrames::RAMSize);
+
+    slot.sequence.store(sequence + 2, std::memory_order_release);
+    frames->published.store(++published, std::memory_order_release);
+}
+
+bool FrameServer::lockstep() const {
+    return frames && frames->control.lockstep.load(std::memory_order_acquire);
+}
+
+bool FrameServer::caughtUp() const {
+    return !frames || frames->control.consumed.load(std::memory_order_acquire) >= published;
+}
+
+bool FrameServer::quitRequested() const {
+    return frames && frames->control.quit.load(std::memory_order_acquire);
+}
+
+FrameServer::~FrameServer() {
+    close();
+}
@@ -0,0 +1,80 @@
+/******************************************************************************
+
+Copyright (C) 2025 Neil Richardson (nrich@neiltopia.com)
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, version 3.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+
+******************************************************************************/
+
+#ifndef FRAMESERVER_H
+#define FRAMESERVER_H
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+
+#include "Gamate.h"
+
+// SharedFrames.h is left to clients, it brings in windows.h on Windows
+struct SharedFrames;
+
+/*
+    Publishes every emulated frame's shades, RAM and index into a named
+    shared memory ring (POSIX shm_open, a named file mapping on Windows)
+    laid out as in SharedFrames.h, and takes held buttons from its
+    control block, so agents and dashboards in other processes follow
+    the emulation without linking it or copying through a socket.
+*/
+class FrameServer {
+    SharedFrames *frames = nullptr;
+    std::string name;
+    uint64_t published = 0;
+
+#ifdef _WIN64
+    void *mapping_handle = nullptr;
+#endif
+public:
+    FrameServer();
+
+    FrameServer(const FrameServer &) = delete;
+    FrameServer &operator=(const FrameServer &) = delete;
+
+    // name as for shm_open, e.g. "/megata", replacing anything left by a server that crashed
+    bool open(const std::string &name);
+    void close();
+
+    bool active() const {
+        return frames != nullptr;
+    }
+
+    // the client's buttons, when it is driving them, replace button_state
+    void applyInput(uint8_t &button_state) const;
+
+    // after each frame, with the buttons it ran with
+    void publish(const Gamate &gamate);
+
+    bool lockstep() const;
+
+    // lockstep: the client is finished with every published frame
+    bool caughtUp() const;
+
+    bool quitRequested() const;
+
+    uint64_t frameCount() const {
+        return published;
+    }
+
+    ~FrameServer();
+};
+
+#endif //FRAMESERVER_H
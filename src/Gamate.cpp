@@ -0,0 +1,441 @@
+/******************************************************************************
+
+Copyright (C) 2025 Neil Richardson (nrich@neiltopia.com)
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, version 3.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+
+******************************************************************************/
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+#include "Gamate.h"
+#include "Trace.h"
+
+Gamate::Gamate(uint32_t sample_rate) : cpu([this](uint16_t address) { return read(address); }, [this](uint16_t address, uint8_t value) { write(address, value); }, [](){ return INT::QUIT; }) {
+    PSG_init(&psg, 4433000/4, sample_rate);
+    PSG_setVolumeMode(&psg, 2);
+    PSG_set_quality(&psg, true);
+    PSG_setFlags(&psg, EMU2149_ZX_STEREO);
+    PSG_reset(&psg);
+
+    cpu.setPeriod(32768);
+    cpu.reset();
+}
+
+void Gamate::setROM(std::shared_ptr<const SharedImage> image) {
+    rom = std::move(image);
+
+    rom_data = rom ? rom->data() : nullptr;
+    rom_size = rom ? rom->size() : 0;
+}
+
+void Gamate::setBIOS(std::shared_ptr<const SharedImage> image) {
+    bios = std::move(image);
+
+    bios_data = bios ? bios->data() : nullptr;
+    bios_size = bios ? std::min(bios->size(), BIOSSize) : 0;
+
+    bios_overlay.reset();
+    bios_version++;
+}
+
+uint8_t Gamate::read(uint16_t address) {
+    if (address >= 0x0000 && address <= 0x1FFF) {
+        // 1KiB RAM mirrored 8 times
+        return running_state.RAM[address & 0x03FF];
+    }
+
+    if (address >= 0x2000 && address <= 0x3FFF) {
+        // peripheral space
+        return 0xFF;
+    }
+
+    if (address >= 0x4000 && address <= 0x43FF) {
+        // audio
+        return 0xFF;
+    }
+
+    if (address >= 0x4400 && address <= 0x47FF) {
+        // UART TX
+        return running_state.button_state;
+    }
+
+    if (address >= 0x4800 && address <= 0x4BFF) {
+        // UART RX
+        return 0x00;
+    }
+
+    if (address >= 0x4C00 && address <= 0x4FFF) {
+        // TX shift register?
+        return 0xFF;
+    }
+
+    if (address >= 0x5000 && address <= 0x53FF) {
+        // LCD (8) registers
+        return lcd.read(address);
+    }
+
+    if (address >= 0x5400 && address <= 0x57FF) {
+        // reads external space, which is usually 0xFF
+        return 0xFF;
+    }
+
+    if (address >= 0x5800 && address <= 0x58FF) {
+        //reads open bus
+        return 0xFF;
+    }
+
+    if (address >= 0x5900 && address <= 0x59FF) {
+        // Write address?
+        return 0xFF;
+    }
+
+    if (address >= 0x5A00 && address <= 0x5AFF) {
+        //always returns 11b in bits 1:0, the other 6 bits are open bus (i.e. reads 5Bh)
+        return 0x5B;
+    }
+
+    if (address >= 0x5B00 && address <= 0x5FFF) {
+        // Open bus
+        return 0x5B;
+    }
+
+    /*
+        Split ROM address space into 2 16KiB banks
+    */
+    if (address >= 0x6000 && address <= 0x9FFF) {
+        // ROM (cartridge) data (bank 0)
+        if (running_state.protection_check) {
+            uint8_t check = 0;
+
+            check = ((0x47 >> --running_state.protection_check) & 0x01) << 1;
+
+            return check;
+        }
+
+        uint32_t offset = running_state.bank0_offset + (address - 0x6000);
+
+        return offset < rom_size ? rom_data[offset] : 0x00;
+    }
+
+    if (address >= 0xA000 && address <= 0xDFFF) {
+        // ROM (cartridge) data (bank 1)
+        uint32_t offset = running_state.bank1_offset + (address - 0xA000);
+
+        return offset < rom_size ? rom_data[offset] : 0x00;
+    }
+
+    if (address >= 0xE000 && address <= 0xFFFF) {
+        // BIOS (4k repeated twice)
+        uint16_t offset = address & 0x0FFF;
+
+        if (bios_overlay)
+            return (*bios_overlay)[offset];
+
+        return offset < bios_size ? bios_data[offset] : 0x00;
+    }
+
+    std::cerr << "ADDRESS " << std::hex << address << " NOT HANDLED\n";
+    exit(-1);
+
+    return 0x00;
+}
+
+uint8_t Gamate::peek(uint16_t address) const {
+    if (address <= 0x1FFF)
+        return running_state.RAM[address & 0x03FF];
+
+    if (address >= 0x6000 && address <= 0x9FFF) {
+        uint32_t offset = running_state.bank0_offset + (address - 0x6000);
+
+        return offset < rom_size ? rom_data[offset] : 0x00;
+    }
+
+    if (address >= 0xA000 && address <= 0xDFFF) {
+        uint32_t offset = running_state.bank1_offset + (address - 0xA000);
+
+        return offset < rom_size ? rom_data[offset] : 0x00;
+    }
+
+    if (address >= 0xE000) {
+        uint16_t offset = address & 0x0FFF;
+
+        if (bios_overlay)
+            return (*bios_overlay)[offset];
+
+        return offset < bios_size ? bios_data[offset] : 0x00;
+    }
+
+    // registers and open bus
+    return 0xFF;
+}
+
+void Gamate::write(uint16_t address, uint8_t value) {
+    if (address >= 0x0000 && address <= 0x1FFF) {
+        running_state.RAM[address & 0x03FF] = value;
+        dirty_ram |= 1 << ((address & 0x03FF) / RAMChunkSize);
+        return;
+    }
+
+    if (address >= 0x2000 && address <= 0x3FFF) {
+        // peripheral space
+        return;
+    }
+
+    if (address >= 0x4000 && address <= 0x43FF) {
+        // Audio, frames emulated during run ahead are never heard
+        if (!running_state.run_ahead) {
+            PSG_writeReg(&psg, address & 0x0F, value);
+        }
+        return;
+    }
+
+    if (address >= 0x4400 && address <= 0x47FF) {
+        // UART TX
+        return;
+    }
+
+    if (address >= 0x4800 && address <= 0x4BFF) {
+        // UART RX
+        return;
+    }
+
+    if (address >= 0x4C00 && address <= 0x4FFF) {
+        // TX shift register?
+        return;
+    }
+
+    if (address >= 0x5000 && address <= 0x53FF) {
+        // LCD (8) registers
+        
+        lcd.write(address, value);
+        return;
+    }
+
+    if (address >= 0x5400 && address <= 0x57FF) {
+        // reads external space, which is usually 0xFF
+        return;
+    }
+
+    if (address >= 0x5800 && address <= 0x58FF) {
+        //reads open bus
+        return;
+    }
+
+    if (address >= 0x5900 && address <= 0x59FF) {
+        // Write address?
+        return;
+    }
+
+    if (address >= 0x5A00 && address <= 0x5AFF) {
+        //always returns 11b in bits 1:0, the other 6 bits are open bus (i.e. reads 5Bh)
+        return;
+    }
+
+    if (address >= 0x5B00 && address <= 0x5FFF) {
+        // Open bus
+        return;
+    }
+
+    if (address >= 0x6000 && address <= 0xDFFF) {
+        // ROM (cartridge) data
+        if (address == 0xC000) {
+            // Standard bank switcher
+            running_state.bank1_offset = 0x4000 * value;
+        }
+
+        if (address == 0x8000) {
+            // 4 in 1 Regular bank switcher
+            running_state.bank0_offset = 0x4000 * value;
+        }
+        return;
+    }
+
+    if (address >= 0xE000 && address <= 0xFFFF) {
+        // BIOS (4k repeated twice), written through a private copy so the image stays shared
+        if (!bios_overlay) {
+            bios_overlay = std::make_unique<std::array<uint8_t, 4096>>();
+            copyBIOS(*bios_overlay);
+        }
+
+        (*bios_overlay)[address & 0x0FFF] = value;
+        bios_version++;
+        return;
+    }
+
+    std::cerr << "ADDRESS " << std::hex << address << " NOT HANDLED\n";
+    exit(-1);
+
+}
+
+void Gamate::setBusHook(std::function<void(uint16_t, uint8_t, bool)> hook) {
+    bus_hook = std::move(hook);
+    connectBus();
+}
+
+void Gamate::setPatches(std::vector<Patch> list) {
+    patches = std::move(list);
+    patched_pages.fill(0);
+
+    for (const auto &entry : patches) {
+        uint8_t &count = patched_pages[entry.address >> 8];
+
+        if (count < 0xFF)
+            count++;
+    }
+
+    connectBus();
+}
+
+uint8_t Gamate::patch(uint16_t address, uint8_t value) const {
+    uint8_t original = value;
+
+    for (const auto &entry : patches) {
+        if (entry.address == address && (entry.compare < 0 || entry.compare == original))
+            value = entry.value;
+    }
+
+    return value;
+}
+
+void Gamate::connectBus() {
+    auto write_direct = [this](uint16_t address, uint8_t value) { write(address, value); };
+
+    if (!bus_hook && patches.empty()) {
+        cpu.setBus([this](uint16_t address) { return read(address); }, write_direct);
+        return;
+    }
+
+    if (!bus_hook) {
+        cpu.setBus([this](uint16_t address) {
+            uint8_t value = read(address);
+            return patched_pages[address >> 8] ? patch(address, value) : value;
+        }, write_direct);
+        return;
+    }
+
+    // the hook sees what the CPU sees, patches included
+    cpu.setBus([this](uint16_t address) {
+        uint8_t value = read(address);
+
+        if (patched_pages[address >> 8])
+            value = patch(address, value);
+
+        bus_hook(address, value, false);
+        return value;
+    }, [this](uint16_t address, uint8_t value) {
+        bus_hook(address, value, true);
+        write(address, value);
+    });
+}
+
+void Gamate::reset() {
+    PSG_reset(&psg);
+
+    running_state.reset(running_state.paused, running_state.audio_enabled);
+    touchRAM();
+    lcd.reset();
+
+    bios_overlay.reset();
+    bios_version++;
+
+    segment = 0;
+
+    cpu.setPeriod(32768);
+    cpu.reset();
+}
+
+bool Gamate::runFrame() {
+    static const char *SegmentNames[3] = {"CPU run 1", "CPU run 2", "CPU run 3"};
+
+    while (segment < 3) {
+        {
+            Trace::Zone zone(SegmentNames[segment]);
+            cpu.run();
+        }
+
+        if (cpu.stopped())
+            return false;
+
+        switch (segment++) {
+            case 0: {
+                Trace::Zone zone("IRQ");
+                cpu.interupt(INT::IRQ);
+                cpu.setPeriod(32768);
+                break;
+            }
+            case 1: {
+                Trace::Zone zone("IRQ");
+                cpu.interupt(INT::IRQ);
+                cpu.setPeriod(7364);
+                break;
+            }
+            default:
+                cpu.setPeriod(32768 - 7364);
+        }
+    }
+
+    segment = 0;
+
+    return true;
+}
+
+void Gamate::loadRAM(const std::array<uint8_t, 1024> &data) {
+    for (size_t chunk = 0; chunk < data.size() / RAMChunkSize; chunk++) {
+        size_t offset = chunk * RAMChunkSize;
+
+        if (std::memcmp(&running_state.RAM[offset], &data[offset], RAMChunkSize)) {
+            std::memcpy(&running_state.RAM[offset], &data[offset], RAMChunkSize);
+            dirty_ram |= 1 << chunk;
+        }
+    }
+}
+
+void Gamate::copyBIOS(std::array<uint8_t, 4096> &data) const {
+    if (bios_overlay) {
+        data = *bios_overlay;
+        return;
+    }
+
+    data.fill(0x00);
+    if (bios_data)
+        std::memcpy(data.data(), bios_data, bios_size);
+}
+
+void Gamate::restoreBIOS(const std::array<uint8_t, 4096> &data) {
+    // only keep an overlay if the BIOS really differs from the image
+    bool modified = bios_size < BIOSSize || !bios_data || std::memcmp(data.data(), bios_data, BIOSSize) != 0;
+
+    if (!modified) {
+        if (bios_overlay) {
+            bios_overlay.reset();
+            bios_version++;
+        }
+        return;
+    }
+
+    if (!bios_overlay) {
+        bios_overlay = std::make_unique<std::array<uint8_t, 4096>>();
+    } else if (*bios_overlay == data) {
+        return;
+    }
+
+    *bios_overlay = data;
+    bios_version++;
+}
+
+Gamate::~Gamate() {
+
+}
@@ -0,0 +1,169 @@
+/******************************************************************************
+
+Copyright (C) 2025 Neil Richardson (nrich@neiltopia.com)
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, version 3.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+
+******************************************************************************/
+
+#ifndef GAMATE_H
+#define GAMATE_H
+
+#include <cstdint>
+#include <cstddef>
+#include <array>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include <emu2149.h>
+
+#include "CPU.h"
+#include "Emulation.h"
+#include "SharedImage.h"
+#include "LCD.h"
+
+/*
+    One emulated console: CPU, LCD, PSG and RAM wired to the memory map.
+    ROM and BIOS are shared immutable images, BIOS writes go to a copy
+    on write overlay owned by this instance.
+*/
+class Gamate {
+public:
+    // a read of address returns value instead, when compare is not
+    // negative only while the real byte there equals it (for banked ROM)
+    struct Patch {
+        uint16_t address;
+        uint8_t value;
+        int16_t compare;
+    };
+private:
+    std::shared_ptr<const SharedImage> rom;
+    std::shared_ptr<const SharedImage> bios;
+
+    const uint8_t *rom_data = nullptr;
+    size_t rom_size = 0;
+
+    const uint8_t *bios_data = nullptr;
+    size_t bios_size = 0;
+
+    std::unique_ptr<std::array<uint8_t, 4096>> bios_overlay;
+
+    // bumped whenever the BIOS contents may change, for caches of decoded code
+    uint32_t bios_version = 0;
+
+    // CPU run segment of the current frame, only non zero after a debugger break
+    int32_t segment = 0;
+
+    // 64 byte RAM chunks written since clearDirtyRAM(), for StateHash
+    uint16_t dirty_ram = 0xFFFF;
+
+    std::function<void(uint16_t, uint8_t, bool)> bus_hook;
+
+    // patches by page so unpatched reads only cost a table lookup, the
+    // bus is only wrapped at all while there are patches
+    std::vector<Patch> patches;
+    std::array<uint8_t, 256> patched_pages = {};
+
+    uint8_t patch(uint16_t address, uint8_t value) const;
+    void connectBus();
+public:
+    static const size_t MaxROMSize = 524288; // biggest rom is 512KiB
+    static const size_t BIOSSize = 4096;
+
+    CPU cpu;
+    LCD lcd;
+    PSG psg;
+    RunningState running_state;
+
+    Gamate(uint32_t sample_rate = 44100);
+
+    Gamate(const Gamate &) = delete;
+    Gamate &operator=(const Gamate &) = delete;
+
+    void setROM(std::shared_ptr<const SharedImage> image);
+    void setBIOS(std::shared_ptr<const SharedImage> image);
+
+    const std::shared_ptr<const SharedImage> &romImage() const {
+        return rom;
+    }
+
+    const std::shared_ptr<const SharedImage> &biosImage() const {
+        return bios;
+    }
+
+    uint32_t biosVersion() const {
+        return bios_version;
+    }
+
+    bool ready() const {
+        return rom && bios;
+    }
+
+    uint8_t read(uint16_t address);
+
+    // reads memory without side effects, for debugging tools
+    uint8_t peek(uint16_t address) const;
+    void write(uint16_t address, uint8_t value);
+
+    // reports every CPU memory access (address, value, is write) to hook,
+    // an empty hook restores the direct bus
+    void setBusHook(std::function<void(uint16_t, uint8_t, bool)> hook);
+
+    // replaces the read patches (cheats), an empty list restores the direct bus
+    void setPatches(std::vector<Patch> list);
+
+    const std::vector<Patch> &patchList() const {
+        return patches;
+    }
+
+    void reset();
+
+    // returns false when a debugger break stopped the CPU, the next call
+    // carries on from there
+    bool runFrame();
+
+    bool midFrame() const {
+        return cpu.stopped();
+    }
+
+    // drops a frame left part way by a debugger break, for state loads
+    void restartFrame() {
+        segment = 0;
+    }
+
+    static const size_t RAMChunkSize = 64;
+
+    uint16_t dirtyRAM() const {
+        return dirty_ram;
+    }
+
+    void clearDirtyRAM() {
+        dirty_ram = 0;
+    }
+
+    // after writing running_state.RAM directly
+    void touchRAM() {
+        dirty_ram = 0xFFFF;
+    }
+
+    // copies only the chunks that differ, so hashes stay incremental across state loads
+    void loadRAM(const std::array<uint8_t, 1024> &data);
+
+    void copyBIOS(std::array<uint8_t, 4096> &data) const;
+    void restoreBIOS(const std::array<uint8_t, 4096> &data);
+
+    ~Gamate();
+};
+
+#endif //GAMATE_H
@@ -0,0 +1,206 @@
+/******************************************************************************
+
+Copyright (C) 2025 Neil Richardson (nrich@neiltopia.com)
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, version 3.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+
+******************************************************************************/
+
+
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+#include <fcntl.h>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+#ifndef O_BINARY
+#define O_BINARY 0
+#endif
+
+#include "Disassembler.h"
+#include "InstructionTrace.h"
+
+/*
+    File layout is the header followed by `count` records, oldest first.
+*/
+struct InstructionTraceHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t record_size;
+    uint32_t reserved;
+    uint64_t count;
+};
+
+static const char InstructionTraceMagic[4] = {'M', 'G', 'T', 'I'};
+static const uint32_t InstructionTraceVersion = 1;
+
+// only async signal safe calls are made from the crash handler, so the
+// path and trace are stashed up front
+static const InstructionTrace *crash_trace = nullptr;
+static char crash_path[1024];
+
+InstructionTrace::InstructionTrace(size_t capacity) {
+    size_t size = 1;
+
+    while (size < capacity)
+        size <<= 1;
+
+    mask = size - 1;
+}
+
+std::vector<InstructionTrace::Record> InstructionTrace::snapshot() const {
+    std::vector<Record> out;
+    out.reserve(size());
+
+    for (uint64_t i = position - size(); i < position; i++)
+        out.push_back(records[i & mask]);
+
+    return out;
+}
+
+bool InstructionTrace::save(const std::string &filename) const {
+    std::ofstream fh(filename, std::ios::binary|std::ios::out|std::ios::trunc);
+
+    if (!fh)
+        return false;
+
+    InstructionTraceHeader header = {};
+    std::memcpy(header.magic, InstructionTraceMagic, sizeof(header.magic));
+    header.version = InstructionTraceVersion;
+    header.record_size = sizeof(Record);
+    header.count = size();
+
+    fh.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    // the ring wraps at most once, so it is written in two pieces
+    size_t start = (position - size()) & mask;
+    size_t first = std::min(size(), records.size() - start);
+
+    fh.write(reinterpret_cast<const char*>(&records[start]), first * sizeof(Record));
+    fh.write(reinterpret_cast<const char*>(records.data()), (size() - first) * sizeof(Record));
+
+    return fh.good();
+}
+
+bool InstructionTrace::Load(const std::string &filename, std::vector<Record> &out) {
+    std::ifstream fh(filename, std::ios::binary|std::ios::in);
+
+    if (!fh)
+        return false;
+
+    InstructionTraceHeader header;
+    if (!fh.read(reinterpret_cast<char*>(&header), sizeof(header)))
+        return false;
+
+    if (std::memcmp(header.magic, InstructionTraceMagic, sizeof(header.magic)) || header.version != InstructionTraceVersion || header.record_size != sizeof(Record))
+        return false;
+
+    // the count comes from the file, check it against the records actually there before allocating
+    std::streampos records_start = fh.tellg();
+    fh.seekg(0, std::ios::end);
+    uint64_t available = (fh.tellg() - records_start) / sizeof(Record);
+    fh.seekg(records_start);
+
+    if (header.count > available)
+        return false;
+
+    out.resize(header.count);
+
+    return (bool)fh.read(reinterpret_cast<char*>(out.data()), out.size() * sizeof(Record));
+}
+
+void InstructionTrace::CrashHandler(int signal) {
+    const InstructionTrace *trace = crash_trace;
+
+    if (trace) {
+        crash_trace = nullptr;
+
+        int fd = open(crash_path, O_WRONLY|O_CREAT|O_TRUNC|O_BINARY, 0644);
+
+        if (fd >= 0) {
+            InstructionTraceHeader header = {};
+            std::memcpy(header.magic, InstructionTraceMagic, sizeof(header.magic));
+            header.version = InstructionTraceVersion;
+            header.record_size = sizeof(Record);
+            header.count = trace->size();
+
+            size_t start = (trace->position - trace->size()) & trace->mask;
+            size_t first = std::min(trace->size(), trace->records.size() - start);
+
+            bool ok = write(fd, &header, sizeof(header)) == sizeof(header);
+            ok = ok && write(fd, &trace->records[start], first * sizeof(Record)) >= 0;
+            ok = ok && write(fd, trace->records.data(), (trace->size() - first) * sizeof(Record)) >= 0;
+            close(fd);
+        }
+    }
+
+    std::signal(signal, SIG_DFL);
+    std::raise(signal);
+}
+
+void InstructionTrace::dumpOnCrash(const std::string &filename) {
+    snprintf(crash_path, sizeof(crash_path), "%s", filename.c_str());
+    crash_trace = this;
+
+    std::signal(SIGSEGV, CrashHandler);
+    std::signal(SIGABRT, CrashHandler);
+    std::signal(SIGFPE, CrashHandler);
+    std::signal(SIGILL, CrashHandler);
+}
+
+std::string InstructionTrace::Format(const Record &record) {
+    static const char Flags[] = "CZIDBRVN";
+
+    uint8_t bytes[3] = {record.opcode, record.operands[0], record.operands[1]};
+
+    char disassembly[Disassembler::MaxText];
+    int32_t length = Disassembler::Format(bytes, record.pc, disassembly);
+
+    char hex[12];
+    switch (length) {
+        case 3:
+            snprintf(hex, sizeof(hex), "%02X %02X %02X", bytes[0], bytes[1], bytes[2]);
+            break;
+        case 2:
+            snprintf(hex, sizeof(hex), "%02X %02X", bytes[0], bytes[1]);
+            break;
+        default:
+            snprintf(hex, sizeof(hex), "%02X", bytes[0]);
+    }
+
+    char flags[9];
+    for (int32_t bit = 0; bit < 8; bit++)
+        flags[7 - bit] = record.P & (1 << bit) ? Flags[bit] : '.';
+    flags[8] = 0;
+
+    char line[128];
+    snprintf(line, sizeof(line), "%12llu %02X:%02X %04X  %-8s  %-14s A:%02X X:%02X Y:%02X S:%02X P:%s +%u",
+        (unsigned long long)record.cycle, record.bank0_offset / 0x4000, record.bank1_offset / 0x4000, record.pc,
+        hex, disassembly, record.A, record.X, record.Y, record.S, flags, record.cycles);
+
+    return line;
+}
+
+InstructionTrace::~InstructionTrace() {
+    if (crash_trace == this)
+        crash_trace = nullptr;
+
+    disable();
+}
@@ -0,0 +1,140 @@
+/******************************************************************************
+
+Copyright (C) 2025 Neil Richardson (nrich@neiltopia.com)
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, version 3.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+
+******************************************************************************/
+
+
+#ifndef INSTRUCTIONTRACE_H
+#define INSTRUCTIONTRACE_H
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "Gamate.h"
+
+/*
+    Binary ring buffer of executed instructions for chasing desyncs. Each
+    record holds the machine state before the instruction ran, copied
+    without any formatting, and megata-tracedump turns a saved trace into
+    text. The CPU is only hooked while enabled, so a disabled trace costs
+    nothing.
+*/
+class InstructionTrace {
+public:
+    struct Record {
+        uint64_t cycle; // CPU cycles before the instruction
+        uint32_t bank0_offset;
+        uint32_t bank1_offset;
+        uint16_t pc;
+        uint8_t opcode;
+        uint8_t operands[2];
+        uint8_t A;
+        uint8_t X;
+        uint8_t Y;
+        uint8_t S;
+        uint8_t P;
+        uint8_t cycles;
+        uint8_t reserved[5];
+    };
+
+    static_assert(sizeof(Record) == 32, "trace records are written as is");
+private:
+    Gamate *gamate = nullptr;
+
+    // allocated on the first enable, 32 bytes per instruction adds up
+    std::vector<Record> records;
+    size_t mask;
+    uint64_t position = 0;
+
+    inline void record(uint16_t pc, uint8_t opcode, uint8_t cycles) {
+        // run ahead frames are rolled back, they are not part of the timeline
+        if (gamate->running_state.run_ahead)
+            return;
+
+        Record &entry = records[position++ & mask];
+        CPU::State state;
+
+        gamate->cpu.saveState(state);
+
+        entry.cycle = gamate->cpu.cycleCount() - cycles;
+        entry.bank0_offset = gamate->running_state.bank0_offset;
+        entry.bank1_offset = gamate->running_state.bank1_offset;
+        entry.pc = pc;
+        entry.opcode = opcode;
+        entry.operands[0] = gamate->peek(pc + 1);
+        entry.operands[1] = gamate->peek(pc + 2);
+        entry.A = state.A;
+        entry.X = state.X;
+        entry.Y = state.Y;
+        entry.S = state.S;
+        entry.P = state.P;
+        entry.cycles = cycles;
+    }
+
+    static void CrashHandler(int signal);
+public:
+    // capacity is rounded up to a power of two records
+    InstructionTrace(size_t capacity = 1 << 20);
+
+    void enable(Gamate &target) {
+        if (records.empty())
+            records.resize(mask + 1);
+
+        gamate = &target;
+        gamate->cpu.addStepHook(this, [this](uint16_t pc, uint8_t opcode, uint8_t cycles) { record(pc, opcode, cycles); });
+    }
+
+    void disable() {
+        if (gamate)
+            gamate->cpu.removeStepHook(this);
+
+        gamate = nullptr;
+    }
+
+    bool enabled() const {
+        return gamate != nullptr;
+    }
+
+    void clear() {
+        position = 0;
+    }
+
+    size_t capacity() const {
+        return mask + 1;
+    }
+
+    // records currently held, at most capacity()
+    size_t size() const {
+        return position < records.size() ? position : records.size();
+    }
+
+    // oldest record first
+    std::vector<Record> snapshot() const;
+
+    bool save(const std::string &filename) const;
+    static bool Load(const std::string &filename, std::vector<Record> &out);
+
+    // saves this trace to filename if the process crashes
+    void dumpOnCrash(const std::string &filename);
+
+    static std::string Format(const Record &record);
+
+    ~InstructionTrace();
+};
+
+#endif //INSTRUCTIONTRACE_H
@@ -18,6 +18,7 @@ this program. If not, see <https://www.gnu.org/licenses/>.
 
 #include "LCD.h"
 
+#include <cstring>
 #include <ios>
 #include <iostream>
 
@@ -61,6 +62,7 @@ void LCD::positionY(const uint8_t y) {
 
 void LCD::raw(const uint8_t data) {
     bitPlanes[bitPlaneSelected][vramAddress & 0x1FFF] = data;
+    dirty_chunks |= 1ull << (bitPlaneSelected * 32 + (vramAddress & 0x1FFF) / ChunkSize);
     vramAddressIncrement();
 }
 
@@ -130,6 +132,8 @@ uint32_t LCD::getPixel(const int x_pos, const int y_pos) const {
 }
 
 void LCD::update(const std::array<uint32_t, 4> &palette, std::array<uint32_t, ScreenWidth*ScreenHeight> &screen) {
+    changed = false;
+
     if (displayBlank) {
         screen.fill(palette[0]);
         return;
@@ -146,16 +150,76 @@ void LCD::update(const std::array<uint32_t, 4> &palette, std::array<uint32_t, Sc
     }
 }
 
+/*
+    Bit n of a bitplane byte spread to the low bit of byte 7 - n, so one
+    lookup per plane gives the shades of 8 pixels in screen order.
+*/
+static const std::array<uint64_t, 256> SpreadBits = []() {
+    std::array<uint64_t, 256> table;
+
+    for (int value = 0; value < 256; value++) {
+        uint8_t pixels[8];
+
+        for (int pixel = 0; pixel < 8; pixel++) {
+            pixels[pixel] = (value >> (7 - pixel)) & 0x01;
+        }
+
+        std::memcpy(&table[value], pixels, sizeof(pixels));
+    }
+
+    return table;
+}();
+
+void LCD::render(std::array<uint8_t, ScreenWidth*ScreenHeight> &shades) const {
+    render(shades.data());
+}
+
+void LCD::render(uint8_t *shades) const {
+    if (displayBlank) {
+        std::memset(shades, 0, ScreenWidth*ScreenHeight);
+        return;
+    }
+
+    const auto &lower_plane = bitPlanes[swapBitPlanes ? 1 : 0];
+    const auto &upper_plane = bitPlanes[swapBitPlanes ? 0 : 1];
+
+    for (int scan_line = 0; scan_line < ScreenHeight; scan_line += 1) {
+        auto real = translate(scan_line);
+
+        const uint8_t *lower = lower_plane.data() + (real.second & 0xFF) * 0x20;
+        const uint8_t *upper = upper_plane.data() + (real.second & 0xFF) * 0x20;
+
+        uint8_t *out = shades + scan_line * ScreenWidth;
+
+        // each group of 8 pixels straddles two bytes unless the scroll is a multiple of 8
+        const int shift = real.first & 0x07;
+
+        for (int x = 0; x < ScreenWidth; x += 8) {
+            int column = ((real.first + x) & 0xFF) >> 3;
+            int next_column = (column + 1) & 0x1F;
+
+            uint8_t lower_bits = ((lower[column] << 8) | lower[next_column]) >> (8 - shift);
+            uint8_t upper_bits = ((upper[column] << 8) | upper[next_column]) >> (8 - shift);
+
+            uint64_t pixels = SpreadBits[lower_bits] | (SpreadBits[upper_bits] << 1);
+            std::memcpy(out + x, &pixels, sizeof(pixels));
+        }
+    }
+}
+
 void LCD::write(uint16_t address, uint8_t value) {
     switch (address & 0x0007) {
         case 1:
             control(value);
+            changed = true;
             break;
         case 2:
             scrollHorizontal(value);
+            changed = true;
             break;
         case 3:
             scrollVertical(value);
+            changed = true;
             break;
         case 4:
             positionX(value);
@@ -165,6 +229,7 @@ void LCD::write(uint16_t address, uint8_t value) {
             break;
         case 7:
             raw(value);
+            changed = true;
             break;
     }
 }
@@ -175,6 +240,75 @@ uint8_t LCD::read(uint16_t address) {
     return data;
 }
 
+void LCD::saveState(State &state) const {
+    state.bitPlanes = bitPlanes;
+
+    state.bitPlaneSelected = bitPlaneSelected;
+
+    state.displayBlank = displayBlank;
+    state.incrementVertical = incrementVertical;
+    state.swapBitPlanes = swapBitPlanes;
+    state.windowMode = windowMode;
+    state.noRefresh = noRefresh;
+
+    state.vramAddress = vramAddress;
+
+    state.xScroll = xScroll;
+    state.yScroll = yScroll;
+}
+
+void LCD::loadState(const State &state) {
+    // only chunks that differ are copied and marked, loads are mostly small deltas
+    for (size_t plane = 0; plane < 2; plane++) {
+        for (size_t chunk = 0; chunk < 0x2000 / ChunkSize; chunk++) {
+            size_t offset = chunk * ChunkSize;
+
+            if (std::memcmp(&bitPlanes[plane][offset], &state.bitPlanes[plane][offset], ChunkSize)) {
+                std::memcpy(&bitPlanes[plane][offset], &state.bitPlanes[plane][offset], ChunkSize);
+                dirty_chunks |= 1ull << (plane * 32 + chunk);
+            }
+        }
+    }
+
+    bitPlaneSelected = state.bitPlaneSelected;
+
+    displayBlank = state.displayBlank;
+    incrementVertical = state.incrementVertical;
+    swapBitPlanes = state.swapBitPlanes;
+    windowMode = state.windowMode;
+    noRefresh = state.noRefresh;
+
+    vramAddress = state.vramAddress;
+
+    xScroll = state.xScroll;
+    yScroll = state.yScroll;
+
+    changed = true;
+}
+
+static uint64_t pack_registers(int32_t bit_plane_selected, bool display_blank, bool increment_vertical, bool swap_bit_planes, bool window_mode, bool no_refresh, uint16_t vram_address, uint8_t x_scroll, uint8_t y_scroll) {
+    uint64_t key = vram_address & 0x1FFF;
+
+    key = (key << 8) | x_scroll;
+    key = (key << 8) | y_scroll;
+    key = (key << 1) | (bit_plane_selected & 0x01);
+    key = (key << 1) | display_blank;
+    key = (key << 1) | increment_vertical;
+    key = (key << 1) | swap_bit_planes;
+    key = (key << 1) | window_mode;
+    key = (key << 1) | no_refresh;
+
+    return key;
+}
+
+uint64_t LCD::registerKey() const {
+    return pack_registers(bitPlaneSelected, displayBlank, incrementVertical, swapBitPlanes, windowMode, noRefresh, vramAddress, xScroll, yScroll);
+}
+
+uint64_t LCD::RegisterKey(const State &state) {
+    return pack_registers(state.bitPlaneSelected, state.displayBlank, state.incrementVertical, state.swapBitPlanes, state.windowMode, state.noRefresh, state.vramAddress, state.xScroll, state.yScroll);
+}
+
 LCD::~LCD() {
 
 }
@@ -42,6 +42,12 @@ class LCD {
     uint8_t xScroll = 0;
     uint8_t yScroll = 0;
 
+    // set when anything visible may differ from the last update()
+    bool changed = true;
+
+    // 256 byte VRAM chunks written, bit plane * 32 + offset / 256
+    uint64_t dirty_chunks = ~0ull;
+
     void control(const uint8_t control_byte);
     void scrollHorizontal(const uint8_t scroll);
     void scrollVertical(const uint8_t scroll);
@@ -58,13 +64,43 @@ public:
     const static int ScreenWidth = 160;
     const static int ScreenHeight = 150;
 
+    struct State {
+        std::array<std::array<uint8_t, 0x2000>, 2> bitPlanes;
+
+        int32_t bitPlaneSelected;
+
+        bool displayBlank;
+        bool incrementVertical;
+        bool swapBitPlanes;
+        bool windowMode;
+        bool noRefresh;
+
+        uint16_t vramAddress;
+
+        uint8_t xScroll;
+        uint8_t yScroll;
+
+        bool operator==(const State &) const = default;
+    };
+
     LCD();
 
     void update(const std::array<uint32_t, 4> &palette, std::array<uint32_t, ScreenWidth*ScreenHeight> &screen);
 
+    // shade (0-3) of every pixel, without touching the redraw flag
+    void render(std::array<uint8_t, ScreenWidth*ScreenHeight> &shades) const;
+
+    // the same into ScreenWidth*ScreenHeight bytes of the caller's, e.g. a batch of observations
+    void render(uint8_t *shades) const;
+
     void write(uint16_t address, uint8_t value);
     uint8_t read(uint16_t address);
 
+    // raw 256x256 VRAM plane, 32 bytes per row, for the debugger
+    const std::array<uint8_t, 0x2000> &bitPlane(int plane) const {
+        return bitPlanes[plane];
+    }
+
     void reset() {
         bitPlanes[0].fill(0x00);
         bitPlanes[1].fill(0x00);
@@ -81,8 +117,37 @@ public:
 
         xScroll = 0;
         yScroll = 0;
+
+        changed = true;
+        dirty_chunks = ~0ull;
+    }
+
+    bool hasChanged() const {
+        return changed;
+    }
+
+    static const size_t ChunkSize = 256;
+
+    // VRAM chunks written since clearDirtyChunks(), for StateHash
+    uint64_t dirtyChunks() const {
+        return dirty_chunks;
     }
 
+    void clearDirtyChunks() {
+        dirty_chunks = 0;
+    }
+
+    void touchChunks() {
+        dirty_chunks = ~0ull;
+    }
+
+    // every register but the bitplanes packed into one value, for StateHash
+    uint64_t registerKey() const;
+    static uint64_t RegisterKey(const State &state);
+
+    void saveState(State &state) const;
+    void loadState(const State &state);
+
     ~LCD();
 
 };
@@ -0,0 +1,541 @@
+/******************************************************************************
+
+Copyright (C) 2025 Neil Richardson (nrich@neiltopia.com)
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, version 3.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+
+******************************************************************************/
+
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#include <miniz.h>
+
+#include "Emulation.h"
+#include "Gamate.h"
+#include "Library.h"
+#include "MappedFile.h"
+
+/*
+    Index layout is the header, the library directory (32 bit length and
+    bytes), then `count` records each followed by the path and member
+    strings. Titles and mappers are not stored, they come from the
+    database when the index is loaded.
+*/
+struct LibraryHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t count;
+    uint32_t root_length;
+};
+
+struct LibraryRecord {
+    int64_t modified;
+    uint64_t file_size;
+    uint32_t size;
+    uint32_t crc;
+    uint8_t sha1[20];
+    uint32_t path_length;
+    uint32_t member_length;
+};
+
+static const char LibraryMagic[4] = {'M', 'G', 'T', 'L'};
+static const uint32_t LibraryVersion = 1;
+
+static std::string lowercase_extension(const std::string &filename) {
+    std::string lc_filename = filename;
+    std::transform(lc_filename.begin(), lc_filename.end(), lc_filename.begin(), (int(*)(int)) tolower);
+
+    size_t dot = lc_filename.find_last_of(".");
+    return dot == std::string::npos ? "" : lc_filename.substr(dot + 1);
+}
+
+static bool parse_sha1(const std::string &text, SHA1Digest &digest) {
+    if (text.length() != digest.size() * 2)
+        return false;
+
+    for (size_t i = 0; i < digest.size(); i++) {
+        char *end = nullptr;
+        std::string byte = text.substr(i * 2, 2);
+
+        digest[i] = std::strtoul(byte.c_str(), &end, 16);
+
+        if (*end)
+            return false;
+    }
+
+    return true;
+}
+
+Library::Library() : entries(std::make_shared<const std::vector<Entry>>()), busy(false), scanned(0), total(0) {
+
+}
+
+/*
+    Database lines are
+
+        crc32 size mapper sha1 title
+
+    with the CRC32 and SHA-1 in hex, "-" for an unknown SHA-1, and mapper
+    one of plain, standard or 4in1. Blank lines and lines starting with
+    # are ignored.
+*/
+bool Library::loadDatabase(const std::string &filename) {
+    std::ifstream fh(filename);
+
+    if (!fh)
+        return false;
+
+    std::multimap<uint32_t, Known> loaded;
+    std::string line;
+    int32_t line_number = 0;
+
+    while (std::getline(fh, line)) {
+        line_number++;
+
+        if (line.empty() || line[0] == '#' || line.find_first_not_of(" \t\r") == std::string::npos)
+            continue;
+
+        std::istringstream fields(line);
+
+        uint32_t crc = 0;
+        std::string mapper, sha1, title;
+        Known known = {};
+
+        fields >> std::hex >> crc >> std::dec >> known.size >> mapper >> sha1;
+        std::getline(fields >> std::ws, title);
+
+        if (!title.empty() && title.back() == '\r')
+            title.pop_back();
+
+        known.has_sha1 = sha1 != "-";
+
+        if (mapper == "plain") {
+            known.mapper = Mapper::Plain;
+        } else if (mapper == "standard") {
+            known.mapper = Mapper::Standard;
+        } else if (mapper == "4in1") {
+            known.mapper = Mapper::FourInOne;
+        } else {
+            known.mapper = Mapper::Unknown;
+        }
+
+        if (!fields.eof() || title.empty() || (known.has_sha1 && !parse_sha1(sha1, known.sha1))) {
+            std::cerr << "Ignoring bad database line " << line_number << " in " << filename << "\n";
+            continue;
+        }
+
+        known.title = title;
+        loaded.emplace(crc, known);
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    database = std::move(loaded);
+
+    // refresh titles of anything already listed
+    auto refreshed = std::make_shared<std::vector<Entry>>(*entries);
+    for (auto &entry : *refreshed) {
+        identify(entry);
+    }
+    entries = refreshed;
+
+    return true;
+}
+
+void Library::identify(Entry &entry) const {
+    auto range = database.equal_range(entry.crc);
+
+    for (auto it = range.first; it != range.second; ++it) {
+        const Known &known = it->second;
+
+        if (known.size != entry.size || (known.has_sha1 && known.sha1 != entry.sha1))
+            continue;
+
+        entry.title = known.title;
+        entry.mapper = known.mapper;
+        entry.known = true;
+        return;
+    }
+
+    // not in the database, make a guess from the file
+    entry.title = std::filesystem::path(entry.member.length() ? entry.member : entry.path).stem().string();
+    entry.mapper = entry.size <= 0x8000 ? Mapper::Plain : Mapper::Standard;
+    entry.known = false;
+}
+
+std::vector<Library::Entry> Library::HashFile(const std::filesystem::path &path, int64_t modified, uint64_t file_size) {
+    std::vector<Entry> found;
+
+    Entry entry = {};
+    entry.path = path.string();
+    entry.modified = modified;
+    entry.file_size = file_size;
+
+    if (lowercase_extension(entry.path) == "zip") {
+        mz_zip_archive zip_archive = {0};
+
+        if (!mz_zip_reader_init_file(&zip_archive, entry.path.c_str(), 0))
+            return found;
+
+        std::vector<uint8_t> buffer;
+
+        for (uint32_t i = 0; i < mz_zip_reader_get_num_files(&zip_archive); i++) {
+            mz_zip_archive_file_stat file_stat;
+
+            if (!mz_zip_reader_file_stat(&zip_archive, i, &file_stat))
+                break;
+
+            if (file_stat.m_is_directory || lowercase_extension(file_stat.m_filename) != "bin")
+                continue;
+
+            if (file_stat.m_uncomp_size == 0 || file_stat.m_uncomp_size > Gamate::MaxROMSize)
+                continue;
+
+            buffer.resize(file_stat.m_uncomp_size);
+            if (!mz_zip_reader_extract_to_mem(&zip_archive, i, buffer.data(), buffer.size(), 0))
+                continue;
+
+            entry.member = file_stat.m_filename;
+            entry.size = buffer.size();
+            entry.crc = file_stat.m_crc32;
+            entry.sha1 = SHA1::Hash(buffer.data(), buffer.size());
+
+            found.push_back(entry);
+        }
+
+        mz_zip_reader_end(&zip_archive);
+    } else {
+        MappedFile mapping(entry.path);
+
+        if (!mapping.valid() || mapping.size() > Gamate::MaxROMSize)
+            return found;
+
+        entry.size = mapping.size();
+        entry.crc = mz_crc32(MZ_CRC32_INIT, mapping.data(), mapping.size());
+        entry.sha1 = SHA1::Hash(mapping.data(), mapping.size());
+
+        found.push_back(entry);
+    }
+
+    return found;
+}
+
+void Library::scanFiles(std::string directory, Entries previous) {
+    struct Candidate {
+        std::filesystem::path path;
+        int64_t modified;
+        uint64_t file_size;
+    };
+
+    std::vector<Candidate> candidates;
+    std::error_code ec;
+
+    auto options = std::filesystem::directory_options::skip_permission_denied | std::filesystem::directory_options::follow_directory_symlink;
+
+    for (auto it = std::filesystem::recursive_directory_iterator(directory, options, ec); !ec && it != std::filesystem::recursive_directory_iterator(); it.increment(ec)) {
+        std::error_code file_ec;
+
+        if (!it->is_regular_file(file_ec))
+            continue;
+
+        std::string extension = lowercase_extension(it->path().filename().string());
+
+        if (extension != "bin" && extension != "zip")
+            continue;
+
+        Candidate candidate;
+        candidate.path = it->path();
+        candidate.modified = it->last_write_time(file_ec).time_since_epoch().count();
+        candidate.file_size = it->file_size(file_ec);
+
+        if (!file_ec)
+            candidates.push_back(candidate);
+    }
+
+    // files that have not changed since the last scan are not rehashed
+    std::map<std::string, std::vector<const Entry*>> unchanged;
+    for (const auto &entry : *previous) {
+        unchanged[entry.path].push_back(&entry);
+    }
+
+    std::vector<std::vector<Entry>> results(candidates.size());
+    std::atomic<size_t> next(0);
+
+    scanned = 0;
+    total = candidates.size();
+
+    auto work = [&]() {
+        for (size_t i = next++; i < candidates.size(); i = next++) {
+            const Candidate &candidate = candidates[i];
+
+            auto it = unchanged.find(candidate.path.string());
+
+            if (it != unchanged.end() && it->second.front()->modified == candidate.modified && it->second.front()->file_size == candidate.file_size) {
+                for (const Entry *entry : it->second) {
+                    results[i].push_back(*entry);
+                }
+            } else {
+                results[i] = HashFile(candidate.path, candidate.modified, candidate.file_size);
+            }
+
+            scanned++;
+        }
+    };
+
+    size_t thread_count = std::max<size_t>(1, std::min<size_t>(std::thread::hardware_concurrency(), candidates.size()));
+    std::vector<std::thread> threads;
+
+    for (size_t i = 1; i < thread_count; i++) {
+        threads.emplace_back(work);
+    }
+
+    work();
+
+    for (auto &thread : threads) {
+        thread.join();
+    }
+
+    auto scanned_entries = std::make_shared<std::vector<Entry>>();
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        for (auto &found : results) {
+            for (auto &entry : found) {
+                identify(entry);
+                scanned_entries->push_back(std::move(entry));
+            }
+        }
+
+        std::sort(scanned_entries->begin(), scanned_entries->end(), [](const Entry &a, const Entry &b) {
+            if (a.title != b.title)
+                return a.title < b.title;
+            if (a.path != b.path)
+                return a.path < b.path;
+            return a.member < b.member;
+        });
+
+        // the directory may have been changed while scanning
+        if (directory == root)
+            entries = scanned_entries;
+    }
+
+    if (!saveIndex()) {
+        std::cerr << "Could not write library index " << IndexPath().string() << "\n";
+    }
+
+    busy = false;
+}
+
+std::filesystem::path Library::IndexPath() {
+    std::filesystem::path directory = cache_directory();
+
+    if (directory.empty())
+        return directory;
+
+    return directory / "library.idx";
+}
+
+bool Library::loadIndex() {
+    std::filesystem::path path = IndexPath();
+
+    if (path.empty())
+        return false;
+
+    std::ifstream fh(path, std::ios::binary|std::ios::in|std::ios::ate);
+
+    if (!fh)
+        return false;
+
+    // lengths come from the file, a truncated or corrupt index is discarded rather than sized from them
+    std::streamoff file_size = fh.tellg();
+    fh.seekg(0);
+
+    auto fits = [&](uint64_t length) {
+        return length <= (uint64_t)(file_size - fh.tellg());
+    };
+
+    LibraryHeader header;
+    if (!fh.read(reinterpret_cast<char*>(&header), sizeof(header)))
+        return false;
+
+    if (std::memcmp(header.magic, LibraryMagic, sizeof(header.magic)) || header.version != LibraryVersion)
+        return false;
+
+    if (!fits(header.root_length))
+        return false;
+
+    std::string directory(header.root_length, '\0');
+    if (!fh.read(directory.data(), directory.size()))
+        return false;
+
+    auto loaded = std::make_shared<std::vector<Entry>>();
+
+    for (uint32_t i = 0; i < header.count; i++) {
+        LibraryRecord record;
+        if (!fh.read(reinterpret_cast<char*>(&record), sizeof(record)))
+            return false;
+
+        Entry entry = {};
+        entry.modified = record.modified;
+        entry.file_size = record.file_size;
+        entry.size = record.size;
+        entry.crc = record.crc;
+        std::memcpy(entry.sha1.data(), record.sha1, entry.sha1.size());
+
+        if (!fits((uint64_t)record.path_length + record.member_length))
+            return false;
+
+        entry.path.resize(record.path_length);
+        entry.member.resize(record.member_length);
+
+        if (!fh.read(entry.path.data(), entry.path.size()) || !fh.read(entry.member.data(), entry.member.size()))
+            return false;
+
+        loaded->push_back(std::move(entry));
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    if (busy)
+        return false;
+
+    for (auto &entry : *loaded) {
+        identify(entry);
+    }
+
+    root = directory;
+    entries = loaded;
+
+    return true;
+}
+
+bool Library::saveIndex() const {
+    std::filesystem::path path = IndexPath();
+
+    if (path.empty())
+        return false;
+
+    std::string directory;
+    Entries saved;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        directory = root;
+        saved = entries;
+    }
+
+    std::error_code ec;
+    std::filesystem::create_directories(path.parent_path(), ec);
+
+    // write then rename so a partially written index is never loaded
+    std::filesystem::path temp_path = path;
+    temp_path += ".tmp";
+
+    {
+        std::ofstream fh(temp_path, std::ios::binary|std::ios::out|std::ios::trunc);
+
+        if (!fh)
+            return false;
+
+        LibraryHeader header;
+        std::memcpy(header.magic, LibraryMagic, sizeof(header.magic));
+        header.version = LibraryVersion;
+        header.count = saved->size();
+        header.root_length = directory.size();
+
+        fh.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        fh.write(directory.data(), directory.size());
+
+        for (const auto &entry : *saved) {
+            LibraryRecord record = {};
+            record.modified = entry.modified;
+            record.file_size = entry.file_size;
+            record.size = entry.size;
+            record.crc = entry.crc;
+            std::memcpy(record.sha1, entry.sha1.data(), entry.sha1.size());
+            record.path_length = entry.path.size();
+            record.member_length = entry.member.size();
+
+            fh.write(reinterpret_cast<const char*>(&record), sizeof(record));
+            fh.write(entry.path.data(), entry.path.size());
+            fh.write(entry.member.data(), entry.member.size());
+        }
+
+        if (!fh.good()) {
+            fh.close();
+            std::filesystem::remove(temp_path, ec);
+            return false;
+        }
+    }
+
+    std::filesystem::rename(temp_path, path, ec);
+
+    return !ec;
+}
+
+void Library::setDirectory(const std::string &directory) {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    if (directory == root)
+        return;
+
+    root = directory;
+    entries = std::make_shared<const std::vector<Entry>>();
+}
+
+void Library::scan() {
+    if (busy)
+        return;
+
+    wait();
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    if (root.empty())
+        return;
+
+    busy = true;
+    worker = std::thread(&Library::scanFiles, this, root, entries);
+}
+
+void Library::wait() {
+    if (worker.joinable())
+        worker.join();
+}
+
+Library::Entries Library::list() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return entries;
+}
+
+const char *Library::MapperName(Mapper mapper) {
+    switch (mapper) {
+        case Mapper::Plain:
+            return "Plain";
+        case Mapper::Standard:
+            return "Standard";
+        case Mapper::FourInOne:
+            return "4 in 1";
+        default:
+            return "Unknown";
+    }
+}
+
+Library::~Library() {
+    wait();
+}
@@ -0,0 +1,132 @@
+/******************************************************************************
+
+Copyright (C) 2025 Neil Richardson (nrich@neiltopia.com)
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, version 3.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+
+******************************************************************************/
+
+
+#ifndef LIBRARY_H
+#define LIBRARY_H
+
+#include <cstdint>
+#include <atomic>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "SHA1.h"
+
+/*
+    Index of the ROMs found under a directory tree. Every .bin, and every
+    .bin inside a .zip, is hashed and identified against the ROM database.
+    Scans run on worker threads and the result is kept in a binary index
+    in the cache directory, so later runs start from the index and only
+    rehash files that changed.
+*/
+class Library {
+public:
+    enum class Mapper : uint8_t {
+        Unknown,
+        Plain,      // 32KiB or less, no bank switching
+        Standard,   // bank 1 switched by writes to 0xC000
+        FourInOne,  // bank 0 switched by writes to 0x8000 as well
+    };
+
+    struct Entry {
+        std::string path;
+        std::string member; // file inside a zip, empty for a plain .bin
+        int64_t modified;
+        uint64_t file_size;
+
+        uint32_t size;
+        uint32_t crc;
+        SHA1Digest sha1;
+
+        std::string title;
+        Mapper mapper;
+        bool known;
+    };
+
+    typedef std::shared_ptr<const std::vector<Entry>> Entries;
+private:
+    struct Known {
+        uint32_t size;
+        SHA1Digest sha1;
+        bool has_sha1;
+        Mapper mapper;
+        std::string title;
+    };
+
+    std::multimap<uint32_t, Known> database;
+
+    std::string root;
+    Entries entries;
+    mutable std::mutex mutex;
+
+    std::thread worker;
+    std::atomic<bool> busy;
+    std::atomic<size_t> scanned;
+    std::atomic<size_t> total;
+
+    void identify(Entry &entry) const;
+    void scanFiles(std::string directory, Entries previous);
+
+    static std::filesystem::path IndexPath();
+    static std::vector<Entry> HashFile(const std::filesystem::path &path, int64_t modified, uint64_t file_size);
+public:
+    Library();
+
+    Library(const Library &) = delete;
+    Library &operator=(const Library &) = delete;
+
+    bool loadDatabase(const std::string &filename);
+
+    bool loadIndex();
+    bool saveIndex() const;
+
+    const std::string &directory() const {
+        return root;
+    }
+
+    void setDirectory(const std::string &directory);
+
+    // starts a background rescan of the directory
+    void scan();
+    void wait();
+
+    bool scanning() const {
+        return busy;
+    }
+
+    size_t scanProgress() const {
+        return scanned;
+    }
+
+    size_t scanTotal() const {
+        return total;
+    }
+
+    Entries list() const;
+
+    static const char *MapperName(Mapper mapper);
+
+    ~Library();
+};
+
+#endif //LIBRARY_H
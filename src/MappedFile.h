@@ -0,0 +1,59 @@
+/******************************************************************************
+
+Copyright (C) 2025 Neil Richardson (nrich@neiltopia.com)
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, version 3.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+
+******************************************************************************/
+
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+
+/*
+    Read only memory mapping of a whole file. Mappings of the same file
+    share physical pages through the OS page cache.
+*/
+class MappedFile {
+    const uint8_t *address = nullptr;
+    size_t length = 0;
+
+#ifdef _WIN64
+    void *file_handle = nullptr;
+    void *mapping_handle = nullptr;
+#endif
+public:
+    MappedFile(const std::string &filename);
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    bool valid() const {
+        return address != nullptr;
+    }
+
+    const uint8_t *data() const {
+        return address;
+    }
+
+    size_t size() const {
+        return length;
+    }
+
+    ~MappedFile();
+};
+
+#endif //MAPPEDFILE_H
@@ -0,0 +1,179 @@
+/******************************************************************************
+
+Copyright (C) 2025 Neil Richardson (nrich@neiltopia.com)
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, version 3.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+
+******************************************************************************/
+
+#include <cstring>
+#include <fstream>
+#include <utility>
+
+#include <miniz.h>
+
+#include "Movie.h"
+
+/*
+    File layout is the header followed by `run_count` 3 byte runs of
+    (little endian 16 bit frame count, button byte).
+*/
+struct MovieHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t rom_crc;
+    uint32_t bios_crc;
+    uint32_t frames;
+    uint32_t run_count;
+};
+
+static const char MovieMagic[4] = {'M', 'G', 'T', 'M'};
+static const uint32_t MovieVersion = 1;
+
+Movie::Movie() {
+
+}
+
+uint32_t Movie::CRC(const uint8_t *data, size_t size) {
+    return mz_crc32(MZ_CRC32_INIT, data, size);
+}
+
+void Movie::startRecording(uint32_t new_rom_crc, uint32_t new_bios_crc) {
+    runs.clear();
+    frames = 0;
+
+    rom_crc = new_rom_crc;
+    bios_crc = new_bios_crc;
+
+    mode = Recording;
+}
+
+void Movie::startPlayback() {
+    run_index = 0;
+    run_position = 0;
+
+    mode = runs.size() ? Playing : Idle;
+}
+
+void Movie::stop() {
+    mode = Idle;
+}
+
+void Movie::record(uint8_t buttons) {
+    if (runs.size() && runs.back().buttons == buttons && runs.back().count < 0xFFFF) {
+        runs.back().count++;
+    } else {
+        runs.push_back({1, buttons});
+    }
+
+    frames++;
+}
+
+bool Movie::next(uint8_t &buttons) {
+    if (run_index >= runs.size()) {
+        mode = Idle;
+        return false;
+    }
+
+    buttons = runs[run_index].buttons;
+
+    if (++run_position >= runs[run_index].count) {
+        run_index++;
+        run_position = 0;
+    }
+
+    return true;
+}
+
+bool Movie::save(const std::string &filename) const {
+    std::ofstream fh(filename, std::ios::binary|std::ios::out|std::ios::trunc);
+
+    if (!fh)
+        return false;
+
+    MovieHeader header;
+    std::memcpy(header.magic, MovieMagic, sizeof(header.magic));
+    header.version = MovieVersion;
+    header.rom_crc = rom_crc;
+    header.bios_crc = bios_crc;
+    header.frames = frames;
+    header.run_count = runs.size();
+
+    fh.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    std::vector<uint8_t> data;
+    data.reserve(runs.size() * 3);
+
+    for (const auto &run : runs) {
+        data.push_back(run.count & 0xFF);
+        data.push_back(run.count >> 8);
+        data.push_back(run.buttons);
+    }
+
+    fh.write(reinterpret_cast<const char*>(data.data()), data.size());
+
+    return fh.good();
+}
+
+bool Movie::load(const std::string &filename) {
+    std::ifstream fh(filename, std::ios::binary|std::ios::in);
+
+    if (!fh)
+        return false;
+
+    MovieHeader header;
+    if (!fh.read(reinterpret_cast<char*>(&header), sizeof(header)))
+        return false;
+
+    if (std::memcmp(header.magic, MovieMagic, sizeof(header.magic)) || header.version != MovieVersion)
+        return false;
+
+    // the run count comes from the file, check it against what is left before allocating
+    std::streampos runs_start = fh.tellg();
+    fh.seekg(0, std::ios::end);
+    uint64_t remaining = fh.tellg() - runs_start;
+    fh.seekg(runs_start);
+
+    if ((uint64_t)header.run_count * 3 > remaining)
+        return false;
+
+    std::vector<uint8_t> data((size_t)header.run_count * 3);
+    if (!fh.read(reinterpret_cast<char*>(data.data()), data.size()))
+        return false;
+
+    std::vector<Run> loaded;
+    loaded.reserve(header.run_count);
+    uint64_t total = 0;
+
+    for (size_t i = 0; i < data.size(); i += 3) {
+        loaded.push_back({(uint32_t)(data[i] | (data[i+1] << 8)), data[i+2]});
+        total += loaded.back().count;
+    }
+
+    if (total != header.frames)
+        return false;
+
+    runs = std::move(loaded);
+
+    rom_crc = header.rom_crc;
+    bios_crc = header.bios_crc;
+    frames = header.frames;
+
+    mode = Idle;
+
+    return true;
+}
+
+Movie::~Movie() {
+
+}
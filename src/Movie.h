@@ -0,0 +1,97 @@
+/******************************************************************************
+
+Copyright (C) 2025 Neil Richardson (nrich@neiltopia.com)
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, version 3.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+
+******************************************************************************/
+
+#ifndef MOVIE_H
+#define MOVIE_H
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/*
+    Input movie, one button byte per emulated frame starting from a
+    reset. Frames are stored as runs of identical button state, and the
+    header carries CRC32s of the ROM and BIOS images it was recorded
+    against.
+*/
+class Movie {
+    struct Run {
+        uint32_t count;
+        uint8_t buttons;
+    };
+
+    enum Mode {
+        Idle,
+        Recording,
+        Playing,
+    };
+
+    std::vector<Run> runs;
+
+    Mode mode = Idle;
+
+    size_t run_index = 0;
+    uint32_t run_position = 0;
+    uint32_t frames = 0;
+
+    uint32_t rom_crc = 0;
+    uint32_t bios_crc = 0;
+public:
+    Movie();
+
+    static uint32_t CRC(const uint8_t *data, size_t size);
+
+    void startRecording(uint32_t new_rom_crc, uint32_t new_bios_crc);
+    void startPlayback();
+    void stop();
+
+    bool recording() const {
+        return mode == Recording;
+    }
+
+    bool playing() const {
+        return mode == Playing;
+    }
+
+    bool active() const {
+        return mode != Idle;
+    }
+
+    uint32_t frameCount() const {
+        return frames;
+    }
+
+    uint32_t romCRC() const {
+        return rom_crc;
+    }
+
+    uint32_t biosCRC() const {
+        return bios_crc;
+    }
+
+    void record(uint8_t buttons);
+    bool next(uint8_t &buttons);
+
+    bool save(const std::string &filename) const;
+    bool load(const std::string &filename);
+
+    ~Movie();
+};
+
+#endif //MOVIE_H
@@ -0,0 +1,424 @@
+/******************************************************************************
+
+Copyright (C) 2025 Neil Richardson (nrich@neiltopia.com)
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, version 3.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+
+******************************************************************************/
+
+
+#ifndef OPCODES_H
+#define OPCODES_H
+
+#include <cstdint>
+#include <array>
+#include <string_view>
+
+#include "CPU.h"
+
+enum class AddressMode : uint8_t {
+    Invalid,
+    Implied,
+    Accumulator,
+    Immediate,
+    ZeroPage,
+    ZeroPageX,
+    ZeroPageY,
+    Absolute,
+    AbsoluteX,
+    AbsoluteY,
+    Indirect,
+    IndirectX,
+    IndirectY,
+    IndirectZeroPage,
+    AbsoluteIndirectX,
+    Relative,
+};
+
+/*
+    Everything known about one opcode. The interpreter charges `cycles`
+    per instruction; `page_penalty` is the extra cycle real hardware takes
+    when indexing or a taken branch crosses a page, which is not emulated.
+    Opcodes the CPU does not implement run as one byte no-ops and have the
+    Invalid mode.
+*/
+struct OpcodeInfo {
+    const char *mnemonic;
+    AddressMode mode;
+    uint8_t length;
+    uint8_t cycles;
+    uint8_t page_penalty;
+    uint8_t flags_read;
+    uint8_t flags_written;
+};
+
+constexpr uint8_t OpcodeLength(AddressMode mode) {
+    switch (mode) {
+        case AddressMode::Immediate:
+        case AddressMode::ZeroPage:
+        case AddressMode::ZeroPageX:
+        case AddressMode::ZeroPageY:
+        case AddressMode::IndirectX:
+        case AddressMode::IndirectY:
+        case AddressMode::IndirectZeroPage:
+        case AddressMode::Relative:
+            return 2;
+        case AddressMode::Absolute:
+        case AddressMode::AbsoluteX:
+        case AddressMode::AbsoluteY:
+        case AddressMode::Indirect:
+        case AddressMode::AbsoluteIndirectX:
+            return 3;
+        default:
+            return 1;
+    }
+}
+
+constexpr uint8_t OpcodeFlagsRead(std::string_view mnemonic) {
+    if (mnemonic == "ADC" || mnemonic == "SBC")
+        return FLAG::C|FLAG::D;
+    if (mnemonic == "ROL" || mnemonic == "ROR" || mnemonic == "BCC" || mnemonic == "BCS")
+        return FLAG::C;
+    if (mnemonic == "BEQ" || mnemonic == "BNE")
+        return FLAG::Z;
+    if (mnemonic == "BMI" || mnemonic == "BPL")
+        return FLAG::N;
+    if (mnemonic == "BVC" || mnemonic == "BVS")
+        return FLAG::V;
+    if (mnemonic == "PHP" || mnemonic == "BRK")
+        return 0xFF;
+
+    return 0;
+}
+
+constexpr uint8_t OpcodeFlagsWritten(std::string_view mnemonic, AddressMode mode) {
+    if (mnemonic == "ADC" || mnemonic == "SBC")
+        return FLAG::N|FLAG::V|FLAG::Z|FLAG::C;
+    if (mnemonic == "ASL" || mnemonic == "LSR" || mnemonic == "ROL" || mnemonic == "ROR" || mnemonic == "CMP" || mnemonic == "CPX" || mnemonic == "CPY")
+        return FLAG::N|FLAG::Z|FLAG::C;
+    // the 65C02's BIT #imm has no memory operand to copy N and V from
+    if (mnemonic == "BIT")
+        return mode == AddressMode::Immediate ? FLAG::Z : FLAG::N|FLAG::V|FLAG::Z;
+    if (mnemonic == "TRB" || mnemonic == "TSB")
+        return FLAG::Z;
+    if (mnemonic == "CLC" || mnemonic == "SEC")
+        return FLAG::C;
+    if (mnemonic == "CLI" || mnemonic == "SEI")
+        return FLAG::I;
+    if (mnemonic == "CLD" || mnemonic == "SED")
+        return FLAG::D;
+    if (mnemonic == "CLV")
+        return FLAG::V;
+    if (mnemonic == "BRK")
+        return FLAG::I|FLAG::D;
+    if (mnemonic == "PLP" || mnemonic == "RTI")
+        return 0xFF;
+
+    for (auto loads : {"LDA", "LDX", "LDY", "AND", "ORA", "EOR", "INC", "DEC", "INX", "INY", "DEX", "DEY", "TAX", "TAY", "TXA", "TYA", "TSX", "PLA", "PLX", "PLY"}) {
+        if (mnemonic == loads)
+            return FLAG::N|FLAG::Z;
+    }
+
+    return 0;
+}
+
+constexpr uint8_t OpcodePagePenalty(std::string_view mnemonic, AddressMode mode) {
+    if (mode == AddressMode::Relative)
+        return 1;
+
+    bool indexed = mode == AddressMode::AbsoluteX || mode == AddressMode::AbsoluteY || mode == AddressMode::IndirectY;
+
+    // stores and read-modify-write always take the extra cycle
+    for (auto fixed : {"STA", "STZ", "ASL", "LSR", "ROL", "ROR", "INC", "DEC"}) {
+        if (mnemonic == fixed)
+            return 0;
+    }
+
+    return indexed ? 1 : 0;
+}
+
+constexpr OpcodeInfo Op(const char *mnemonic, AddressMode mode, uint8_t cycles) {
+    if (mode == AddressMode::Invalid)
+        return {mnemonic, mode, 1, cycles, 0, 0, 0};
+
+    return {mnemonic, mode, OpcodeLength(mode), cycles, OpcodePagePenalty(mnemonic, mode), OpcodeFlagsRead(mnemonic), OpcodeFlagsWritten(mnemonic, mode)};
+}
+
+inline constexpr std::array<OpcodeInfo, 256> Opcodes = [] {
+    using enum AddressMode;
+
+    return std::array<OpcodeInfo, 256> {
+        Op("BRK", Implied, 7), // 00
+        Op("ORA", IndirectX, 6), // 01
+        Op("???", Invalid, 2), // 02
+        Op("???", Invalid, 2), // 03
+        Op("TSB", ZeroPage, 3), // 04
+        Op("ORA", ZeroPage, 3), // 05
+        Op("ASL", ZeroPage, 5), // 06
+        Op("???", Invalid, 5), // 07
+        Op("PHP", Implied, 3), // 08
+        Op("ORA", Immediate, 2), // 09
+        Op("ASL", Accumulator, 2), // 0A
+        Op("???", Invalid, 2), // 0B
+        Op("TSB", Absolute, 2), // 0C
+        Op("ORA", Absolute, 4), // 0D
+        Op("ASL", Absolute, 6), // 0E
+        Op("???", Invalid, 5), // 0F
+        Op("BPL", Relative, 2), // 10
+        Op("ORA", IndirectY, 5), // 11
+        Op("ORA", IndirectZeroPage, 3), // 12
+        Op("???", Invalid, 2), // 13
+        Op("TRB", ZeroPage, 3), // 14
+        Op("ORA", ZeroPageX, 4), // 15
+        Op("ASL", ZeroPageX, 6), // 16
+        Op("???", Invalid, 5), // 17
+        Op("CLC", Implied, 2), // 18
+        Op("ORA", AbsoluteY, 4), // 19
+        Op("INC", Accumulator, 2), // 1A
+        Op("???", Invalid, 2), // 1B
+        Op("TRB", Absolute, 4), // 1C
+        Op("ORA", AbsoluteX, 4), // 1D
+        Op("ASL", AbsoluteX, 7), // 1E
+        Op("???", Invalid, 5), // 1F
+        Op("JSR", Absolute, 6), // 20
+        Op("AND", IndirectX, 6), // 21
+        Op("???", Invalid, 2), // 22
+        Op("???", Invalid, 2), // 23
+        Op("BIT", ZeroPage, 3), // 24
+        Op("AND", ZeroPage, 3), // 25
+        Op("ROL", ZeroPage, 5), // 26
+        Op("???", Invalid, 5), // 27
+        Op("PLP", Implied, 4), // 28
+        Op("AND", Immediate, 2), // 29
+        Op("ROL", Accumulator, 2), // 2A
+        Op("???", Invalid, 2), // 2B
+        Op("BIT", Absolute, 4), // 2C
+        Op("AND", Absolute, 4), // 2D
+        Op("ROL", Absolute, 6), // 2E
+        Op("???", Invalid, 5), // 2F
+        Op("BMI", Relative, 2), // 30
+        Op("AND", IndirectY, 5), // 31
+        Op("AND", IndirectZeroPage, 3), // 32
+        Op("???", Invalid, 2), // 33
+        Op("BIT", ZeroPageX, 4), // 34
+        Op("AND", ZeroPageX, 4), // 35
+        Op("ROL", ZeroPageX, 6), // 36
+        Op("???", Invalid, 5), // 37
+        Op("SEC", Implied, 2), // 38
+        Op("AND", AbsoluteY, 4), // 39
+        Op("DEC", Accumulator, 2), // 3A
+        Op("???", Invalid, 2), // 3B
+        Op("BIT", AbsoluteX, 4), // 3C
+        Op("AND", AbsoluteX, 4), // 3D
+        Op("ROL", AbsoluteX, 7), // 3E
+        Op("???", Invalid, 5), // 3F
+        Op("RTI", Implied, 6), // 40
+        Op("EOR", IndirectX, 6), // 41
+        Op("???", Invalid, 2), // 42
+        Op("???", Invalid, 2), // 43
+        Op("???", Invalid, 2), // 44
+        Op("EOR", ZeroPage, 3), // 45
+        Op("LSR", ZeroPage, 5), // 46
+        Op("???", Invalid, 5), // 47
+        Op("PHA", Implied, 3), // 48
+        Op("EOR", Immediate, 2), // 49
+        Op("LSR", Accumulator, 2), // 4A
+        Op("???", Invalid, 2), // 4B
+        Op("JMP", Absolute, 3), // 4C
+        Op("EOR", Absolute, 4), // 4D
+        Op("LSR", Absolute, 6), // 4E
+        Op("???", Invalid, 5), // 4F
+        Op("BVC", Relative, 2), // 50
+        Op("EOR", IndirectY, 5), // 51
+        Op("EOR", IndirectZeroPage, 3), // 52
+        Op("???", Invalid, 2), // 53
+        Op("???", Invalid, 2), // 54
+        Op("EOR", ZeroPageX, 4), // 55
+        Op("LSR", ZeroPageX, 6), // 56
+        Op("???", Invalid, 5), // 57
+        Op("CLI", Implied, 2), // 58
+        Op("EOR", AbsoluteY, 4), // 59
+        Op("PHY", Implied, 3), // 5A
+        Op("???", Invalid, 2), // 5B
+        Op("???", Invalid, 2), // 5C
+        Op("EOR", AbsoluteX, 4), // 5D
+        Op("LSR", AbsoluteX, 7), // 5E
+        Op("???", Invalid, 5), // 5F
+        Op("RTS", Implied, 6), // 60
+        Op("ADC", IndirectX, 6), // 61
+        Op("???", Invalid, 2), // 62
+        Op("???", Invalid, 2), // 63
+        Op("STZ", ZeroPage, 2), // 64
+        Op("ADC", ZeroPage, 3), // 65
+        Op("ROR", ZeroPage, 5), // 66
+        Op("???", Invalid, 5), // 67
+        Op("PLA", Implied, 4), // 68
+        Op("ADC", Immediate, 2), // 69
+        Op("ROR", Accumulator, 2), // 6A
+        Op("???", Invalid, 2), // 6B
+        Op("JMP", Indirect, 5), // 6C
+        Op("ADC", Absolute, 4), // 6D
+        Op("ROR", Absolute, 6), // 6E
+        Op("???", Invalid, 5), // 6F
+        Op("BVS", Relative, 2), // 70
+        Op("ADC", IndirectY, 5), // 71
+        Op("ADC", IndirectZeroPage, 3), // 72
+        Op("???", Invalid, 2), // 73
+        Op("STZ", ZeroPageX, 4), // 74
+        Op("ADC", ZeroPageX, 4), // 75
+        Op("ROR", ZeroPageX, 6), // 76
+        Op("???", Invalid, 5), // 77
+        Op("SEI", Implied, 2), // 78
+        Op("ADC", AbsoluteY, 4), // 79
+        Op("PLY", Implied, 4), // 7A
+        Op("???", Invalid, 2), // 7B
+        Op("JMP", AbsoluteIndirectX, 2), // 7C
+        Op("ADC", AbsoluteX, 4), // 7D
+        Op("ROR", AbsoluteX, 7), // 7E
+        Op("???", Invalid, 5), // 7F
+        Op("BRA", Relative, 2), // 80
+        Op("STA", IndirectX, 6), // 81
+        Op("???", Invalid, 2), // 82
+        Op("???", Invalid, 2), // 83
+        Op("STY", ZeroPage, 3), // 84
+        Op("STA", ZeroPage, 3), // 85
+        Op("STX", ZeroPage, 3), // 86
+        Op("???", Invalid, 5), // 87
+        Op("DEY", Implied, 2), // 88
+        Op("BIT", Immediate, 2), // 89
+        Op("TXA", Implied, 2), // 8A
+        Op("???", Invalid, 2), // 8B
+        Op("STY", Absolute, 4), // 8C
+        Op("STA", Absolute, 4), // 8D
+        Op("STX", Absolute, 4), // 8E
+        Op("???", Invalid, 5), // 8F
+        Op("BCC", Relative, 2), // 90
+        Op("STA", IndirectY, 6), // 91
+        Op("STA", IndirectZeroPage, 4), // 92
+        Op("???", Invalid, 2), // 93
+        Op("STY", ZeroPageX, 4), // 94
+        Op("STA", ZeroPageX, 4), // 95
+        Op("STX", ZeroPageY, 4), // 96
+        Op("???", Invalid, 5), // 97
+        Op("TYA", Implied, 2), // 98
+        Op("STA", AbsoluteY, 5), // 99
+        Op("TXS", Implied, 2), // 9A
+        Op("???", Invalid, 2), // 9B
+        Op("STZ", Absolute, 4), // 9C
+        Op("STA", AbsoluteX, 5), // 9D
+        Op("STZ", AbsoluteX, 5), // 9E
+        Op("???", Invalid, 5), // 9F
+        Op("LDY", Immediate, 2), // A0
+        Op("LDA", IndirectX, 6), // A1
+        Op("LDX", Immediate, 2), // A2
+        Op("???", Invalid, 2), // A3
+        Op("LDY", ZeroPage, 3), // A4
+        Op("LDA", ZeroPage, 3), // A5
+        Op("LDX", ZeroPage, 3), // A6
+        Op("???", Invalid, 5), // A7
+        Op("TAY", Implied, 2), // A8
+        Op("LDA", Immediate, 2), // A9
+        Op("TAX", Implied, 2), // AA
+        Op("???", Invalid, 2), // AB
+        Op("LDY", Absolute, 4), // AC
+        Op("LDA", Absolute, 4), // AD
+        Op("LDX", Absolute, 4), // AE
+        Op("???", Invalid, 5), // AF
+        Op("BCS", Relative, 2), // B0
+        Op("LDA", IndirectY, 5), // B1
+        Op("LDA", IndirectZeroPage, 3), // B2
+        Op("???", Invalid, 2), // B3
+        Op("LDY", ZeroPageX, 4), // B4
+        Op("LDA", ZeroPageX, 4), // B5
+        Op("LDX", ZeroPageY, 4), // B6
+        Op("???", Invalid, 5), // B7
+        Op("CLV", Implied, 2), // B8
+        Op("LDA", AbsoluteY, 4), // B9
+        Op("TSX", Implied, 2), // BA
+        Op("???", Invalid, 2), // BB
+        Op("LDY", AbsoluteX, 4), // BC
+        Op("LDA", AbsoluteX, 4), // BD
+        Op("LDX", AbsoluteY, 4), // BE
+        Op("???", Invalid, 5), // BF
+        Op("CPY", Immediate, 2), // C0
+        Op("CMP", IndirectX, 6), // C1
+        Op("???", Invalid, 2), // C2
+        Op("???", Invalid, 2), // C3
+        Op("CPY", ZeroPage, 3), // C4
+        Op("CMP", ZeroPage, 3), // C5
+        Op("DEC", ZeroPage, 5), // C6
+        Op("???", Invalid, 5), // C7
+        Op("INY", Implied, 2), // C8
+        Op("CMP", Immediate, 2), // C9
+        Op("DEX", Implied, 2), // CA
+        Op("???", Invalid, 2), // CB
+        Op("CPY", Absolute, 4), // CC
+        Op("CMP", Absolute, 4), // CD
+        Op("DEC", Absolute, 6), // CE
+        Op("???", Invalid, 5), // CF
+        Op("BNE", Relative, 2), // D0
+        Op("CMP", IndirectY, 5), // D1
+        Op("CMP", IndirectZeroPage, 3), // D2
+        Op("???", Invalid, 2), // D3
+        Op("???", Invalid, 2), // D4
+        Op("CMP", ZeroPageX, 4), // D5
+        Op("DEC", ZeroPageX, 6), // D6
+        Op("???", Invalid, 5), // D7
+        Op("CLD", Implied, 2), // D8
+        Op("CMP", AbsoluteY, 4), // D9
+        Op("PHX", Implied, 3), // DA
+        Op("???", Invalid, 2), // DB
+        Op("???", Invalid, 2), // DC
+        Op("CMP", AbsoluteX, 4), // DD
+        Op("DEC", AbsoluteX, 7), // DE
+        Op("???", Invalid, 5), // DF
+        Op("CPX", Immediate, 2), // E0
+        Op("SBC", IndirectX, 6), // E1
+        Op("???", Invalid, 2), // E2
+        Op("???", Invalid, 2), // E3
+        Op("CPX", ZeroPage, 3), // E4
+        Op("SBC", ZeroPage, 3), // E5
+        Op("INC", ZeroPage, 5), // E6
+        Op("???", Invalid, 5), // E7
+        Op("INX", Implied, 2), // E8
+        Op("SBC", Immediate, 2), // E9
+        Op("NOP", Implied, 2), // EA
+        Op("???", Invalid, 2), // EB
+        Op("CPX", Absolute, 4), // EC
+        Op("SBC", Absolute, 4), // ED
+        Op("INC", Absolute, 6), // EE
+        Op("???", Invalid, 5), // EF
+        Op("BEQ", Relative, 2), // F0
+        Op("SBC", IndirectY, 5), // F1
+        Op("SBC", IndirectZeroPage, 3), // F2
+        Op("???", Invalid, 2), // F3
+        Op("???", Invalid, 2), // F4
+        Op("SBC", ZeroPageX, 4), // F5
+        Op("INC", ZeroPageX, 6), // F6
+        Op("???", Invalid, 5), // F7
+        Op("SED", Implied, 2), // F8
+        Op("SBC", AbsoluteY, 4), // F9
+        Op("PLX", Implied, 4), // FA
+        Op("???", Invalid, 2), // FB
+        Op("???", Invalid, 2), // FC
+        Op("SBC", AbsoluteX, 4), // FD
+        Op("INC", AbsoluteX, 7), // FE
+        Op("???", Invalid, 5), // FF
+    };
+}();
+
+static_assert(Opcodes[0x20].length == 3 && Opcodes[0x20].cycles == 6, "JSR abs");
+static_assert(Opcodes[0xB1].page_penalty == 1 && Opcodes[0x91].page_penalty == 0, "indexed reads pay for page crossings, stores do not");
+static_assert(Opcodes[0x69].flags_read == (FLAG::C|FLAG::D), "ADC reads carry and decimal");
+
+#endif //OPCODES_H
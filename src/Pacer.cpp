@@ -0,0 +1,124 @@
+/******************************************************************************
+
+Copyright (C) 2025 Neil Richardson (nrich@neiltopia.com)
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, version 3.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+
+******************************************************************************/
+
+#include <algorithm>
+#include <thread>
+
+#include "Emulation.h"
+#include "Pacer.h"
+
+static const double FrameRate = (double)CPUClock / FrameCycles;
+
+// the audio clock is only trusted if a callback arrived this recently
+static const std::chrono::milliseconds AudioTimeout(100);
+
+Pacer::Pacer(uint32_t sample_rate) : sample_rate(sample_rate) {
+    resync();
+}
+
+void Pacer::audioConsumed(uint32_t sample_frames) {
+    audio_samples.fetch_add(sample_frames, std::memory_order_relaxed);
+    audio_request.store(sample_frames, std::memory_order_relaxed);
+    audio_timestamp.store(Clock::now().time_since_epoch().count(), std::memory_order_release);
+}
+
+bool Pacer::audioActive(Clock::time_point now) const {
+    Clock::time_point last(Clock::duration(audio_timestamp.load(std::memory_order_acquire)));
+
+    return now - last < AudioTimeout;
+}
+
+double Pacer::elapsed(Clock::time_point now) const {
+    double seconds;
+
+    if (origin_audio && audioActive(now)) {
+        Clock::time_point last(Clock::duration(audio_timestamp.load(std::memory_order_acquire)));
+        uint64_t samples = audio_samples.load(std::memory_order_relaxed) - origin_samples;
+
+        // interpolate between callbacks, never past the point the next one is due going by the last one's length
+        double since = std::chrono::duration<double>(now - last).count();
+        double period = (double)audio_request.load(std::memory_order_relaxed) / sample_rate;
+        seconds = (double)samples / sample_rate + std::min(since, period);
+    } else {
+        seconds = std::chrono::duration<double>(now - origin).count();
+    }
+
+    // a callback arriving before its interpolated time would otherwise step the clock back
+    seconds = std::max(seconds, last_elapsed);
+    last_elapsed = seconds;
+
+    return seconds;
+}
+
+void Pacer::sleepUntil(Clock::time_point deadline) const {
+    // OS sleeps overshoot, so sleep most of the way and yield for the rest
+    const auto slack = std::chrono::milliseconds(2);
+
+    auto now = Clock::now();
+    if (deadline - now > slack) {
+        std::this_thread::sleep_for(deadline - now - slack);
+    }
+
+    while (Clock::now() < deadline) {
+        std::this_thread::yield();
+    }
+}
+
+void Pacer::resync() {
+    origin = Clock::now();
+    origin_samples = audio_samples.load(std::memory_order_relaxed);
+    origin_audio = audioActive(origin);
+    last_elapsed = 0;
+    frames = 0;
+}
+
+int32_t Pacer::wait() {
+    while (true) {
+        auto now = Clock::now();
+
+        if (origin_audio != audioActive(now)) {
+            // audio started or stopped, switch clocks
+            resync();
+        }
+
+        double seconds = elapsed(now);
+        int64_t due = (int64_t)(seconds * FrameRate) - (int64_t)frames;
+
+        if (due > MaxCatchUp) {
+            resync();
+            frames = 1;
+            return 1;
+        }
+
+        if (due >= 1) {
+            frames += due;
+            return due;
+        }
+
+        double next = (frames + 1) / FrameRate;
+        sleepUntil(now + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(next - seconds)));
+    }
+}
+
+double Pacer::lead() const {
+    return frames / FrameRate - elapsed(Clock::now());
+}
+
+Pacer::~Pacer() {
+
+}
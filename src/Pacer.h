@@ -0,0 +1,76 @@
+/******************************************************************************
+
+Copyright (C) 2025 Neil Richardson (nrich@neiltopia.com)
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, version 3.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+
+******************************************************************************/
+
+#ifndef PACER_H
+#define PACER_H
+
+#include <cstdint>
+#include <atomic>
+#include <chrono>
+
+/*
+    Decides when emulated frames are due. While the audio device is
+    pulling samples the clock is the number of samples it has consumed,
+    interpolated between callbacks, so video stays locked to audio.
+    Without audio it falls back to the steady clock.
+*/
+class Pacer {
+    typedef std::chrono::steady_clock Clock;
+
+    // more frames than this behind and the schedule restarts rather than catching up
+    static const int32_t MaxCatchUp = 3;
+
+    uint32_t sample_rate;
+
+    std::atomic<uint64_t> audio_samples{0};
+    std::atomic<int64_t> audio_timestamp{0};
+    std::atomic<uint32_t> audio_request{0};
+
+    Clock::time_point origin;
+    uint64_t origin_samples = 0;
+    bool origin_audio = false;
+
+    // the clock never runs backwards between resyncs
+    mutable double last_elapsed = 0;
+
+    uint64_t frames = 0;
+
+    bool audioActive(Clock::time_point now) const;
+    double elapsed(Clock::time_point now) const;
+    void sleepUntil(Clock::time_point deadline) const;
+public:
+    Pacer(uint32_t sample_rate);
+
+    // called from the audio thread with the number of sample frames consumed
+    void audioConsumed(uint32_t sample_frames);
+
+    void resync();
+    int32_t wait();
+
+    // sample frames asked for by the last audio callback
+    uint32_t audioRequest() const {
+        return audio_request.load(std::memory_order_relaxed);
+    }
+
+    // seconds the emulated frames are ahead (positive) or behind the clock
+    double lead() const;
+
+    ~Pacer();
+};
+
+#endif //PACER_H
@@ -0,0 +1,116 @@
+/******************************************************************************
+
+Copyright (C) 2025 Neil Richardson (nrich@neiltopia.com)
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, version 3.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+
+******************************************************************************/
+
+
+#include <algorithm>
+
+#include "Perf.h"
+
+Perf::Perf() {
+    frame_start = phase_start = rate_start = Clock::now();
+}
+
+void Perf::endFrame(uint64_t instructions, uint64_t cycles, int32_t frames) {
+    auto now = Clock::now();
+
+    for (int phase = 0; phase < PhaseCount; phase++) {
+        phase_history[phase][position] = std::chrono::duration<float, std::milli>(phase_time[phase]).count();
+        phase_time[phase] = Clock::duration::zero();
+    }
+
+    frame_history[position] = std::chrono::duration<float, std::milli>(now - frame_start).count();
+
+    position = (position + 1) % HistorySize;
+    filled = std::min(filled + 1, HistorySize);
+
+    frame_start = phase_start = now;
+
+    emulated_frames += frames;
+
+    std::chrono::duration<double> rate_elapsed = now - rate_start;
+    if (rate_elapsed.count() >= 0.5) {
+        uint64_t frame_delta = emulated_frames - rate_frames;
+
+        instructions_per_second = (instructions - rate_instructions) / rate_elapsed.count();
+        cycles_per_frame = frame_delta ? double(cycles - rate_cycles) / frame_delta : 0;
+        frames_per_second = frame_delta / rate_elapsed.count();
+
+        rate_start = now;
+        rate_instructions = instructions;
+        rate_cycles = cycles;
+        rate_frames = emulated_frames;
+    }
+}
+
+const char *Perf::PhaseName(Phase phase) {
+    switch (phase) {
+        case Wait:
+            return "Wait";
+        case Emulate:
+            return "Emulate";
+        case LCDUpdate:
+            return "LCD update";
+        case TextureUpload:
+            return "Texture upload";
+        case UI:
+            return "ImGui";
+        case Present:
+            return "Present";
+        default:
+            return "";
+    }
+}
+
+static float average(const float *values, size_t count) {
+    if (!count)
+        return 0;
+
+    float total = 0;
+    for (size_t i = 0; i < count; i++) {
+        total += values[i];
+    }
+
+    return total / count;
+}
+
+static float maximum(const float *values, size_t count) {
+    float result = 0;
+
+    for (size_t i = 0; i < count; i++) {
+        result = std::max(result, values[i]);
+    }
+
+    return result;
+}
+
+// until the ring fills the valid entries are the first `filled`, after that all of them
+float Perf::phaseAverage(Phase phase) const {
+    return average(phase_history[phase].data(), filled);
+}
+
+float Perf::phaseMax(Phase phase) const {
+    return maximum(phase_history[phase].data(), filled);
+}
+
+float Perf::frameAverage() const {
+    return average(frame_history.data(), filled);
+}
+
+float Perf::frameMax() const {
+    return maximum(frame_history.data(), filled);
+}
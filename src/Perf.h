@@ -0,0 +1,141 @@
+/******************************************************************************
+
+Copyright (C) 2025 Neil Richardson (nrich@neiltopia.com)
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, version 3.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+
+******************************************************************************/
+
+
+#ifndef PERF_H
+#define PERF_H
+
+#include <cstdint>
+#include <cstddef>
+#include <array>
+#include <chrono>
+
+/*
+    Per display frame timings for the performance overlay. The main loop
+    calls mark() at the end of each phase, so the cost is one clock read
+    per phase and the counters stay compiled in.
+*/
+class Perf {
+public:
+    enum Phase {
+        Wait,
+        Emulate,
+        LCDUpdate,
+        TextureUpload,
+        UI,
+        Present,
+        PhaseCount,
+    };
+
+    // display frames of history, about 7 seconds at 68Hz
+    static const size_t HistorySize = 480;
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    // milliseconds per phase and in total for each of the last HistorySize frames
+    std::array<std::array<float, HistorySize>, PhaseCount> phase_history = {};
+    std::array<float, HistorySize> frame_history = {};
+
+    std::array<Clock::duration, PhaseCount> phase_time = {};
+
+    size_t position = 0;
+    size_t filled = 0;
+
+    Clock::time_point frame_start;
+    Clock::time_point phase_start;
+
+    // instruction and cycle rates, refreshed twice a second
+    Clock::time_point rate_start;
+    uint64_t rate_instructions = 0;
+    uint64_t rate_cycles = 0;
+    uint64_t rate_frames = 0;
+    uint64_t emulated_frames = 0;
+
+    double instructions_per_second = 0;
+    double cycles_per_frame = 0;
+    double frames_per_second = 0;
+
+    uint32_t audio_request = 0;
+    double audio_lead = 0;
+public:
+    Perf();
+
+    void mark(Phase phase) {
+        auto now = Clock::now();
+        phase_time[phase] += now - phase_start;
+        phase_start = now;
+    }
+
+    // closes the display frame that started at the previous endFrame()
+    void endFrame(uint64_t instructions, uint64_t cycles, int32_t frames);
+
+    void setAudio(uint32_t request, double lead) {
+        audio_request = request;
+        audio_lead = lead;
+    }
+
+    static const char *PhaseName(Phase phase);
+
+    // ring buffers for ImGui plots, oldest entry at historyOffset()
+    const float *phaseHistory(Phase phase) const {
+        return phase_history[phase].data();
+    }
+
+    const float *frameHistory() const {
+        return frame_history.data();
+    }
+
+    size_t historyOffset() const {
+        return position;
+    }
+
+    size_t historyCount() const {
+        return filled;
+    }
+
+    float phaseAverage(Phase phase) const;
+    float phaseMax(Phase phase) const;
+    float frameAverage() const;
+    float frameMax() const;
+
+    double instructionsPerSecond() const {
+        return instructions_per_second;
+    }
+
+    double cyclesPerFrame() const {
+        return cycles_per_frame;
+    }
+
+    double emulatedFPS() const {
+        return frames_per_second;
+    }
+
+    uint32_t audioRequest() const {
+        return audio_request;
+    }
+
+    double audioLead() const {
+        return audio_lead;
+    }
+
+    ~Perf() {
+
+    }
+};
+
+#endif //PERF_H
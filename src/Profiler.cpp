@@ -0,0 +1,153 @@
+/******************************************************************************
+
+Copyright (C) 2025 Neil Richardson (nrich@neiltopia.com)
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, version 3.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+
+******************************************************************************/
+
+
+#include "Profiler.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+
+#include "Disassembler.h"
+
+void Profiler::enable(Gamate &target) {
+    if (active)
+        disable();
+
+    if (gamate != &target) {
+        gamate = &target;
+        reset();
+    } else if (address_counters.empty()) {
+        reset();
+    }
+
+    gamate->cpu.addStepHook(this, [this](uint16_t pc, uint8_t, uint8_t cycles) { count(pc, cycles); });
+    active = true;
+}
+
+void Profiler::disable() {
+    if (!active)
+        return;
+
+    gamate->cpu.removeStepHook(this);
+    active = false;
+}
+
+void Profiler::reset() {
+    size_t rom_size = gamate && gamate->romImage() ? gamate->romImage()->size() : 0;
+
+    rom_counters.assign(rom_size, Counter{});
+    address_counters.assign(0x10000, Counter{});
+
+    total_instructions = 0;
+    total_cycles = 0;
+}
+
+std::vector<Profiler::Hotspot> Profiler::hotspots(size_t limit) const {
+    std::vector<Hotspot> found;
+
+    for (uint32_t i = 0; i < rom_counters.size(); i++) {
+        const Counter &counter = rom_counters[i];
+
+        if (counter.instructions)
+            found.push_back({true, i, counter.address, counter.instructions, counter.cycles, 0.0, ""});
+    }
+
+    for (uint32_t i = 0; i < address_counters.size(); i++) {
+        const Counter &counter = address_counters[i];
+
+        if (counter.instructions)
+            found.push_back({false, i, counter.address, counter.instructions, counter.cycles, 0.0, ""});
+    }
+
+    size_t count = std::min(limit, found.size());
+
+    std::partial_sort(found.begin(), found.begin() + count, found.end(), [](const Hotspot &a, const Hotspot &b) {
+        if (a.cycles != b.cycles)
+            return a.cycles > b.cycles;
+
+        return a.rom == b.rom ? a.location < b.location : a.rom;
+    });
+    found.resize(count);
+
+    const uint8_t *rom_data = gamate && gamate->romImage() ? gamate->romImage()->data() : nullptr;
+    size_t rom_size = gamate && gamate->romImage() ? gamate->romImage()->size() : 0;
+
+    for (auto &hotspot : found) {
+        hotspot.share = total_cycles ? (double)hotspot.cycles / total_cycles : 0.0;
+
+        if (hotspot.rom) {
+            // decode from the ROM itself, the bank may have been switched since
+            hotspot.disassembly = Disassembler::Disassemble([&](uint16_t address) -> uint8_t {
+                uint32_t offset = hotspot.location + (uint16_t)(address - hotspot.address);
+
+                return rom_data && offset < rom_size ? rom_data[offset] : 0x00;
+            }, hotspot.address);
+        } else if (gamate) {
+            hotspot.disassembly = Disassembler::Disassemble([&](uint16_t address) {
+                return gamate->peek(address);
+            }, hotspot.address);
+        }
+    }
+
+    return found;
+}
+
+std::string Profiler::Location(const Hotspot &hotspot) {
+    char text[32];
+
+    if (hotspot.rom)
+        snprintf(text, sizeof(text), "ROM:%05X $%04X", hotspot.location, hotspot.address);
+    else
+        snprintf(text, sizeof(text), "$%04X", hotspot.address);
+
+    return text;
+}
+
+void Profiler::report(std::ostream &out, size_t limit) const {
+    char line[128];
+
+    snprintf(line, sizeof(line), "%llu instructions, %llu cycles\n\n", (unsigned long long)total_instructions, (unsigned long long)total_cycles);
+    out << line;
+
+    snprintf(line, sizeof(line), "%-16s %14s %14s %7s  %s\n", "location", "instructions", "cycles", "cycles%", "disassembly");
+    out << line;
+
+    for (const auto &hotspot : hotspots(limit)) {
+        snprintf(line, sizeof(line), "%-16s %14llu %14llu %6.2f%%  %s\n", Location(hotspot).c_str(), (unsigned long long)hotspot.instructions, (unsigned long long)hotspot.cycles, hotspot.share*100.0, hotspot.disassembly.c_str());
+        out << line;
+    }
+}
+
+bool Profiler::save(const std::string &filename, size_t limit) const {
+    std::ofstream out(filename);
+
+    if (!out) {
+        std::cerr << "Could not open profile report " << filename << "\n";
+        return false;
+    }
+
+    report(out, limit);
+
+    return (bool)out;
+}
+
+Profiler::~Profiler() {
+    disable();
+}
@@ -0,0 +1,130 @@
+/******************************************************************************
+
+Copyright (C) 2025 Neil Richardson (nrich@neiltopia.com)
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, version 3.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+
+******************************************************************************/
+
+
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <cstdint>
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "Gamate.h"
+
+/*
+    Guest profiler counting instructions and cycles per program counter.
+    Cartridge code is keyed by ROM offset through the bank offsets in
+    RunningState, so different banks mapped at the same address are kept
+    apart. It hooks the CPU only while enabled, so it costs nothing when
+    disabled.
+*/
+class Profiler {
+    struct Counter {
+        uint64_t instructions;
+        uint64_t cycles;
+        uint16_t address; // CPU address the location last ran at
+    };
+
+    Gamate *gamate = nullptr;
+
+    // ROM locations by offset, everything else (RAM, BIOS) by CPU address
+    std::vector<Counter> rom_counters;
+    std::vector<Counter> address_counters;
+
+    uint64_t total_instructions = 0;
+    uint64_t total_cycles = 0;
+
+    bool active = false;
+
+    inline void count(uint16_t pc, uint8_t cycles) {
+        const RunningState &state = gamate->running_state;
+        Counter *counter = nullptr;
+
+        // run ahead frames are rolled back, counting them would double up
+        if (state.run_ahead)
+            return;
+
+        if (pc >= 0x6000 && pc <= 0x9FFF) {
+            uint32_t offset = state.bank0_offset + (pc - 0x6000);
+
+            if (offset < rom_counters.size())
+                counter = &rom_counters[offset];
+        } else if (pc >= 0xA000 && pc <= 0xDFFF) {
+            uint32_t offset = state.bank1_offset + (pc - 0xA000);
+
+            if (offset < rom_counters.size())
+                counter = &rom_counters[offset];
+        }
+
+        if (!counter)
+            counter = &address_counters[pc];
+
+        counter->instructions++;
+        counter->cycles += cycles;
+        counter->address = pc;
+
+        total_instructions++;
+        total_cycles += cycles;
+    }
+public:
+    struct Hotspot {
+        bool rom;
+        uint32_t location; // ROM offset when rom, otherwise CPU address
+        uint16_t address;
+        uint64_t instructions;
+        uint64_t cycles;
+        double share; // fraction of all profiled cycles
+        std::string disassembly;
+    };
+
+    Profiler() {
+
+    }
+
+    void enable(Gamate &target);
+    void disable();
+
+    bool enabled() const {
+        return active;
+    }
+
+    // zeroes the counters and resizes them to the current ROM
+    void reset();
+
+    uint64_t instructions() const {
+        return total_instructions;
+    }
+
+    uint64_t cycles() const {
+        return total_cycles;
+    }
+
+    // the busiest locations by cycles, at most limit entries
+    std::vector<Hotspot> hotspots(size_t limit) const;
+
+    static std::string Location(const Hotspot &hotspot);
+
+    void report(std::ostream &out, size_t limit) const;
+    bool save(const std::string &filename, size_t limit) const;
+
+    ~Profiler();
+};
+
+#endif //PROFILER_H
@@ -0,0 +1,306 @@
+/******************************************************************************
+
+Copyright (C) 2025 Neil Richardson (nrich@neiltopia.com)
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, version 3.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+
+******************************************************************************/
+
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <thread>
+
+#include "Gamate.h"
+#include "Movie.h"
+#include "Regression.h"
+#include "Trace.h"
+
+// hashes are of the shade of each pixel, independent of the UI palette
+static const Palette ShadePalette = {0, 1, 2, 3};
+
+static const double FrameRate = double(CPUClock) / FrameCycles;
+
+Regression::Regression(std::shared_ptr<const SharedImage> bios, const std::vector<int32_t> &checkpoints) : bios(bios), checkpoints(checkpoints) {
+    std::sort(this->checkpoints.begin(), this->checkpoints.end());
+    this->checkpoints.erase(std::unique(this->checkpoints.begin(), this->checkpoints.end()), this->checkpoints.end());
+}
+
+std::vector<int32_t> Regression::ParseFrames(const std::string &text) {
+    std::vector<int32_t> frames;
+    std::istringstream fields(text);
+    std::string field;
+
+    while (std::getline(fields, field, ',')) {
+        int32_t frame = std::atoi(field.c_str());
+
+        if (frame > 0)
+            frames.push_back(frame);
+    }
+
+    return frames;
+}
+
+/*
+    Golden files are text, one line per checkpoint:
+
+        crc32 frame rom
+
+    with the ROM named relative to the directory that was run.
+*/
+bool Regression::loadGolden(const std::string &filename) {
+    std::ifstream fh(filename);
+
+    if (!fh)
+        return false;
+
+    std::string line;
+
+    while (std::getline(fh, line)) {
+        if (line.empty() || line[0] == '#')
+            continue;
+
+        std::istringstream fields(line);
+
+        uint32_t crc;
+        int32_t frame;
+        std::string name;
+
+        fields >> std::hex >> crc >> std::dec >> frame;
+        std::getline(fields >> std::ws, name);
+
+        if (!fields.fail() && !name.empty())
+            golden[name][frame] = crc;
+    }
+
+    return true;
+}
+
+bool Regression::saveGolden(const std::string &filename) const {
+    std::ofstream fh(filename, std::ios::out|std::ios::trunc);
+
+    if (!fh)
+        return false;
+
+    fh << "# megata golden screen CRCs: crc32 frame rom\n";
+
+    for (const auto &result : results) {
+        if (!result.loaded)
+            continue;
+
+        for (size_t i = 0; i < result.hashes.size(); i++) {
+            fh << std::hex << std::setw(8) << std::setfill('0') << result.hashes[i] << std::dec << " " << checkpoints[i] << " " << result.name << "\n";
+        }
+    }
+
+    return fh.good();
+}
+
+Regression::Result Regression::runROM(const std::string &directory, const std::string &name) const {
+    Result result = {};
+    result.name = name;
+
+    std::filesystem::path path = std::filesystem::path(directory) / name;
+
+    auto rom = SharedImage::Load(path.string(), Gamate::MaxROMSize);
+
+    if (!rom) {
+        result.error = "could not open ROM";
+        return result;
+    }
+
+    Movie movie;
+    std::filesystem::path movie_path = std::filesystem::path(path).replace_extension(".mgm");
+
+    if (std::filesystem::exists(movie_path)) {
+        if (!movie.load(movie_path.string())) {
+            result.error = "could not open movie " + movie_path.filename().string();
+            return result;
+        }
+
+        if (movie.romCRC() != rom->crc() || movie.biosCRC() != bios->crc()) {
+            result.error = "movie was recorded with a different ROM or BIOS";
+            return result;
+        }
+
+        movie.startPlayback();
+    }
+
+    auto gamate = std::make_unique<Gamate>();
+    gamate->setROM(rom);
+    gamate->setBIOS(bios);
+    gamate->running_state.paused = false;
+    gamate->reset();
+
+    std::array<uint32_t, LCD::ScreenWidth*LCD::ScreenHeight> screen;
+
+    auto start = std::chrono::steady_clock::now();
+
+    size_t next_checkpoint = 0;
+
+    for (int32_t frame = 1; next_checkpoint < checkpoints.size(); frame++) {
+        uint8_t buttons = 0xFF;
+        if (!movie.next(buttons))
+            buttons = 0xFF;
+
+        gamate->running_state.button_state = buttons;
+        gamate->runFrame();
+
+        if (frame == checkpoints[next_checkpoint]) {
+            gamate->lcd.update(ShadePalette, screen);
+            result.hashes.push_back(Movie::CRC(reinterpret_cast<const uint8_t*>(screen.data()), sizeof(screen)));
+            next_checkpoint++;
+        }
+
+        result.frames = frame;
+    }
+
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    result.loaded = true;
+
+    return result;
+}
+
+void Regression::run(const std::string &directory, size_t thread_count) {
+    std::vector<std::string> names;
+    std::error_code ec;
+
+    for (auto it = std::filesystem::recursive_directory_iterator(directory, std::filesystem::directory_options::skip_permission_denied, ec); !ec && it != std::filesystem::recursive_directory_iterator(); it.increment(ec)) {
+        std::error_code file_ec;
+
+        if (!it->is_regular_file(file_ec))
+            continue;
+
+        std::string extension = it->path().extension().string();
+        std::transform(extension.begin(), extension.end(), extension.begin(), (int(*)(int)) tolower);
+
+        if (extension == ".bin" || extension == ".zip")
+            names.push_back(std::filesystem::relative(it->path(), directory, file_ec).generic_string());
+    }
+
+    std::sort(names.begin(), names.end());
+
+    results.assign(names.size(), Result());
+
+    std::atomic<size_t> next(0);
+
+    auto work = [&]() {
+        Trace::NameThread("Regression worker");
+
+        for (size_t i = next++; i < names.size(); i = next++) {
+            Trace::Zone zone("ROM");
+            results[i] = runROM(directory, names[i]);
+        }
+    };
+
+    thread_count = std::max<size_t>(1, std::min(thread_count, names.size()));
+    std::vector<std::thread> threads;
+
+    for (size_t i = 1; i < thread_count; i++) {
+        threads.emplace_back(work);
+    }
+
+    work();
+
+    for (auto &thread : threads) {
+        thread.join();
+    }
+}
+
+int32_t Regression::report(std::ostream &out, bool update) const {
+    int32_t failures = 0;
+    size_t missing = 0;
+    double total_seconds = 0;
+    int64_t total_frames = 0;
+
+    for (const auto &result : results) {
+        if (!result.loaded) {
+            out << "ERROR " << result.name << ": " << result.error << "\n";
+            failures++;
+            continue;
+        }
+
+        total_seconds += result.seconds;
+        total_frames += result.frames;
+
+        double fps = result.frames / std::max(result.seconds, 1e-9);
+
+        std::ostringstream detail;
+        std::string status = "PASS";
+
+        if (update) {
+            status = "SAVE";
+        } else {
+            auto it = golden.find(result.name);
+
+            for (size_t i = 0; i < result.hashes.size(); i++) {
+                if (it == golden.end() || !it->second.count(checkpoints[i])) {
+                    if (status == "PASS")
+                        status = "NEW";
+                    continue;
+                }
+
+                uint32_t expected = it->second.at(checkpoints[i]);
+
+                if (expected != result.hashes[i]) {
+                    status = "FAIL";
+                    char mismatch[64];
+                    std::snprintf(mismatch, sizeof(mismatch), " frame %d expected %08x got %08x", checkpoints[i], expected, result.hashes[i]);
+                    detail << mismatch;
+                }
+            }
+
+            // golden checkpoints this run did not reach, e.g. after --frames changed
+            if (it != golden.end()) {
+                for (const auto &entry : it->second) {
+                    if (std::binary_search(checkpoints.begin(), checkpoints.end(), entry.first))
+                        continue;
+
+                    if (status != "FAIL")
+                        status = "MISSING";
+                    detail << " frame " << entry.first << " not produced";
+                }
+            }
+
+            // NEW fails too, record it with --update-golden once the screens are known good
+            if (status != "PASS")
+                failures++;
+        }
+
+        out << status << " " << result.name << std::fixed << std::setprecision(0) << " (" << fps << " fps, " << (fps / FrameRate) << "x)" << detail.str() << "\n";
+    }
+
+    if (!update) {
+        for (const auto &entry : golden) {
+            bool produced = std::any_of(results.begin(), results.end(), [&](const Result &result) {
+                return result.name == entry.first;
+            });
+
+            if (!produced) {
+                out << "MISSING " << entry.first << ": in the golden file but not found\n";
+                missing++;
+                failures++;
+            }
+        }
+    }
+
+    out << (results.size() + missing) << " ROMs, " << failures << " failed, " << std::setprecision(1) << (total_frames / std::max(total_seconds, 1e-9) / FrameRate) << "x realtime per worker\n";
+
+    return failures;
+}
@@ -0,0 +1,76 @@
+/******************************************************************************
+
+Copyright (C) 2025 Neil Richardson (nrich@neiltopia.com)
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, version 3.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+
+******************************************************************************/
+
+
+#ifndef REGRESSION_H
+#define REGRESSION_H
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "SharedImage.h"
+
+/*
+    Headless golden image test. Every ROM in a directory is booted on
+    its own worker, optionally driven by a movie next to it (game.mgm for
+    game.zip), and the CRC32 of the screen is taken at the chosen frames.
+    The hashes are compared against a golden file written by an earlier
+    known good build.
+*/
+class Regression {
+    struct Result {
+        std::string name;
+        bool loaded;
+        std::string error;
+        std::vector<uint32_t> hashes;
+        int32_t frames;
+        double seconds;
+    };
+
+    std::shared_ptr<const SharedImage> bios;
+    std::vector<int32_t> checkpoints;
+
+    // rom name -> frame -> screen CRC
+    std::map<std::string, std::map<int32_t, uint32_t>> golden;
+
+    std::vector<Result> results;
+
+    Result runROM(const std::string &directory, const std::string &name) const;
+public:
+    Regression(std::shared_ptr<const SharedImage> bios, const std::vector<int32_t> &checkpoints);
+
+    bool loadGolden(const std::string &filename);
+    bool saveGolden(const std::string &filename) const;
+
+    void run(const std::string &directory, size_t thread_count);
+
+    // prints a line per ROM and returns the number of failures, anything but PASS or SAVE
+    int32_t report(std::ostream &out, bool update) const;
+
+    static std::vector<int32_t> ParseFrames(const std::string &text);
+
+    ~Regression() {
+
+    }
+};
+
+#endif //REGRESSION_H
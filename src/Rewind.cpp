@@ -0,0 +1,227 @@
+/******************************************************************************
+
+Copyright (C) 2025 Neil Richardson (nrich@neiltopia.com)
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, version 3.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+
+******************************************************************************/
+
+#include <cstring>
+
+#include <miniz.h>
+
+#include "Rewind.h"
+
+/*
+    Delta layout is a list of (skip, count) word runs, each pair followed
+    by `count` XORed words. Run lengths fit in 16 bits because the whole
+    state does.
+*/
+static_assert((sizeof(SaveState) + 7) / 8 <= 0xFFFF, "SaveState too large for 16 bit delta runs");
+
+Rewind::Rewind(size_t budget, int32_t interval) : budget(budget), interval(interval) {
+    current.fill(0);
+    keyframe.fill(0);
+}
+
+void Rewind::encodeKeyframe(std::vector<uint8_t> &data) {
+    mz_ulong size = mz_compressBound(sizeof(Words));
+
+    data.resize(size);
+    if (mz_compress2(data.data(), &size, reinterpret_cast<const uint8_t*>(current.data()), sizeof(Words), MZ_BEST_SPEED) != MZ_OK) {
+        // fall back to storing the keyframe uncompressed
+        size = sizeof(Words);
+        std::memcpy(data.data(), current.data(), size);
+    }
+
+    data.resize(size);
+    data.shrink_to_fit();
+}
+
+bool Rewind::decodeKeyframe(const std::vector<uint8_t> &data, Words &words) {
+    if (data.size() == sizeof(Words)) {
+        std::memcpy(words.data(), data.data(), sizeof(Words));
+        return true;
+    }
+
+    mz_ulong size = sizeof(Words);
+
+    return mz_uncompress(reinterpret_cast<uint8_t*>(words.data()), &size, data.data(), data.size()) == MZ_OK && size == sizeof(Words);
+}
+
+void Rewind::encodeDelta(std::vector<uint8_t> &data) {
+    scratch.resize(sizeof(Words) + StateWords * 2 * sizeof(uint16_t));
+
+    uint8_t *out = scratch.data();
+    size_t i = 0;
+
+    while (i < StateWords) {
+        size_t start = i;
+        while (i < StateWords && current[i] == keyframe[i])
+            i++;
+
+        uint16_t skip = i - start;
+
+        start = i;
+        while (i < StateWords && current[i] != keyframe[i])
+            i++;
+
+        uint16_t count = i - start;
+
+        if (count == 0)
+            break;
+
+        std::memcpy(out, &skip, sizeof(skip));
+        out += sizeof(skip);
+        std::memcpy(out, &count, sizeof(count));
+        out += sizeof(count);
+
+        for (size_t j = start; j < i; j++) {
+            uint64_t word = current[j] ^ keyframe[j];
+            std::memcpy(out, &word, sizeof(word));
+            out += sizeof(word);
+        }
+    }
+
+    data.assign(scratch.data(), out);
+}
+
+void Rewind::decodeDelta(const std::vector<uint8_t> &data, Words &words) {
+    words = keyframe;
+
+    const uint8_t *in = data.data();
+    const uint8_t *end = in + data.size();
+    size_t i = 0;
+
+    while (in < end) {
+        uint16_t skip;
+        uint16_t count;
+
+        std::memcpy(&skip, in, sizeof(skip));
+        in += sizeof(skip);
+        std::memcpy(&count, in, sizeof(count));
+        in += sizeof(count);
+
+        i += skip;
+
+        for (uint16_t j = 0; j < count; j++) {
+            uint64_t word;
+            std::memcpy(&word, in, sizeof(word));
+            in += sizeof(word);
+
+            words[i++] ^= word;
+        }
+    }
+}
+
+bool Rewind::loadKeyframe() {
+    if (keyframe_valid)
+        return true;
+
+    if (group_size == 0)
+        return false;
+
+    keyframe_valid = decodeKeyframe(frames[frames.size() - group_size].data, keyframe);
+
+    return keyframe_valid;
+}
+
+void Rewind::trim() {
+    // never drop the newest group, its keyframe is still in use
+    while (used > budget && frames.size() > (size_t)group_size) {
+        do {
+            used -= frames.front().data.size() + sizeof(Frame);
+            frames.pop_front();
+        } while (frames.size() > (size_t)group_size && !frames.front().keyframe);
+    }
+}
+
+void Rewind::push(const SaveState &state) {
+    std::memcpy(current.data(), &state, sizeof(SaveState));
+
+    Frame frame;
+
+    if (group_size == 0 || group_size >= interval || !loadKeyframe()) {
+        frame.keyframe = true;
+        encodeKeyframe(frame.data);
+
+        keyframe = current;
+        keyframe_valid = true;
+        group_size = 1;
+    } else {
+        frame.keyframe = false;
+        encodeDelta(frame.data);
+
+        group_size++;
+    }
+
+    used += frame.data.size() + sizeof(Frame);
+    frames.push_back(std::move(frame));
+
+    trim();
+}
+
+bool Rewind::pop(SaveState &state) {
+    if (frames.empty())
+        return false;
+
+    const Frame &frame = frames.back();
+    bool is_keyframe = frame.keyframe;
+
+    if (is_keyframe) {
+        if (!decodeKeyframe(frame.data, current)) {
+            clear();
+            return false;
+        }
+    } else {
+        if (!loadKeyframe()) {
+            clear();
+            return false;
+        }
+
+        decodeDelta(frame.data, current);
+    }
+
+    std::memcpy(&state, current.data(), sizeof(SaveState));
+
+    used -= frame.data.size() + sizeof(Frame);
+    frames.pop_back();
+
+    if (is_keyframe) {
+        // step back into the previous group
+        keyframe_valid = false;
+        group_size = 0;
+
+        for (auto it = frames.rbegin(); it != frames.rend(); ++it) {
+            group_size++;
+
+            if (it->keyframe)
+                break;
+        }
+    } else {
+        group_size--;
+    }
+
+    return true;
+}
+
+void Rewind::clear() {
+    frames.clear();
+    used = 0;
+    group_size = 0;
+    keyframe_valid = false;
+}
+
+Rewind::~Rewind() {
+
+}
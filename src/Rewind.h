@@ -0,0 +1,96 @@
+/******************************************************************************
+
+Copyright (C) 2025 Neil Richardson (nrich@neiltopia.com)
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, version 3.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+
+******************************************************************************/
+
+#ifndef REWIND_H
+#define REWIND_H
+
+#include <cstdint>
+#include <cstddef>
+#include <array>
+#include <deque>
+#include <vector>
+
+#include "SaveState.h"
+
+/*
+    Per frame history of SaveStates. Every `interval` frames a keyframe
+    is stored miniz compressed, the frames in between are stored as the
+    XOR against that keyframe with runs of unchanged 64 bit words
+    collapsed. Whole keyframe groups are dropped from the oldest end to
+    stay within the memory budget.
+*/
+class Rewind {
+    static const size_t StateWords = (sizeof(SaveState) + 7) / 8;
+
+    typedef std::array<uint64_t, StateWords> Words;
+
+    struct Frame {
+        bool keyframe;
+        std::vector<uint8_t> data;
+    };
+
+    std::deque<Frame> frames;
+
+    size_t budget;
+    size_t used = 0;
+
+    int32_t interval;
+    int32_t group_size = 0;
+
+    Words current;
+    Words keyframe;
+    bool keyframe_valid = false;
+
+    std::vector<uint8_t> scratch;
+
+    void encodeKeyframe(std::vector<uint8_t> &data);
+    bool decodeKeyframe(const std::vector<uint8_t> &data, Words &words);
+
+    void encodeDelta(std::vector<uint8_t> &data);
+    void decodeDelta(const std::vector<uint8_t> &data, Words &words);
+
+    bool loadKeyframe();
+    void trim();
+public:
+    Rewind(size_t budget, int32_t interval = 60);
+
+    void setBudget(size_t new_budget) {
+        budget = new_budget;
+        trim();
+    }
+
+    bool enabled() const {
+        return budget > 0;
+    }
+
+    size_t frameCount() const {
+        return frames.size();
+    }
+
+    size_t memoryUsed() const {
+        return used;
+    }
+
+    void push(const SaveState &state);
+    bool pop(SaveState &state);
+    void clear();
+
+    ~Rewind();
+};
+
+#endif //REWIND_H
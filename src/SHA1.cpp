@@ -0,0 +1,134 @@
+/******************************************************************************
+
+Copyright (C) 2025 Neil Richardson (nrich@neiltopia.com)
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, version 3.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+
+******************************************************************************/
+
+
+#include <algorithm>
+#include <cstring>
+
+#include "SHA1.h"
+
+static inline uint32_t rol(uint32_t value, int bits) {
+    return (value << bits) | (value >> (32 - bits));
+}
+
+SHA1::SHA1() : state({0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0}), block_used(0), total(0) {
+
+}
+
+void SHA1::transform(const uint8_t *data) {
+    uint32_t w[80];
+
+    for (int i = 0; i < 16; i++) {
+        w[i] = (uint32_t(data[i*4]) << 24) | (uint32_t(data[i*4 + 1]) << 16) | (uint32_t(data[i*4 + 2]) << 8) | uint32_t(data[i*4 + 3]);
+    }
+
+    for (int i = 16; i < 80; i++) {
+        w[i] = rol(w[i-3] ^ w[i-8] ^ w[i-14] ^ w[i-16], 1);
+    }
+
+    uint32_t a = state[0], b = state[1], c = state[2], d = state[3], e = state[4];
+
+    for (int i = 0; i < 80; i++) {
+        uint32_t f, k;
+
+        if (i < 20) {
+            f = (b & c) | (~b & d);
+            k = 0x5A827999;
+        } else if (i < 40) {
+            f = b ^ c ^ d;
+            k = 0x6ED9EBA1;
+        } else if (i < 60) {
+            f = (b & c) | (b & d) | (c & d);
+            k = 0x8F1BBCDC;
+        } else {
+            f = b ^ c ^ d;
+            k = 0xCA62C1D6;
+        }
+
+        uint32_t temp = rol(a, 5) + f + e + k + w[i];
+        e = d;
+        d = c;
+        c = rol(b, 30);
+        b = a;
+        a = temp;
+    }
+
+    state[0] += a;
+    state[1] += b;
+    state[2] += c;
+    state[3] += d;
+    state[4] += e;
+}
+
+void SHA1::update(const uint8_t *data, size_t size) {
+    total += size;
+
+    if (block_used) {
+        size_t count = std::min(size, block.size() - block_used);
+        std::memcpy(block.data() + block_used, data, count);
+
+        block_used += count;
+        data += count;
+        size -= count;
+
+        if (block_used < block.size())
+            return;
+
+        transform(block.data());
+        block_used = 0;
+    }
+
+    while (size >= block.size()) {
+        transform(data);
+        data += block.size();
+        size -= block.size();
+    }
+
+    std::memcpy(block.data(), data, size);
+    block_used = size;
+}
+
+SHA1Digest SHA1::digest() {
+    uint64_t bits = total * 8;
+
+    uint8_t padding[72] = {0x80};
+    size_t padding_size = (block_used < 56 ? 56 : 120) - block_used;
+
+    for (int i = 0; i < 8; i++) {
+        padding[padding_size + i] = bits >> (56 - i*8);
+    }
+
+    update(padding, padding_size + 8);
+
+    SHA1Digest result;
+
+    for (int i = 0; i < 5; i++) {
+        result[i*4] = state[i] >> 24;
+        result[i*4 + 1] = state[i] >> 16;
+        result[i*4 + 2] = state[i] >> 8;
+        result[i*4 + 3] = state[i];
+    }
+
+    return result;
+}
+
+SHA1Digest SHA1::Hash(const uint8_t *data, size_t size) {
+    SHA1 sha1;
+    sha1.update(data, size);
+    return sha1.digest();
+}
@@ -0,0 +1,53 @@
+/******************************************************************************
+
+Copyright (C) 2025 Neil Richardson (nrich@neiltopia.com)
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, version 3.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+
+******************************************************************************/
+
+
+#ifndef SHA1_H
+#define SHA1_H
+
+#include <cstdint>
+#include <cstddef>
+#include <array>
+
+typedef std::array<uint8_t, 20> SHA1Digest;
+
+/*
+    Incremental SHA-1 (FIPS 180-4), used to identify ROM images against
+    the database. Not for anything security related.
+*/
+class SHA1 {
+    std::array<uint32_t, 5> state;
+    std::array<uint8_t, 64> block;
+    size_t block_used;
+    uint64_t total;
+
+    void transform(const uint8_t *data);
+public:
+    SHA1();
+
+    void update(const uint8_t *data, size_t size);
+    SHA1Digest digest();
+
+    static SHA1Digest Hash(const uint8_t *data, size_t size);
+
+    ~SHA1() {
+
+    }
+};
+
+#endif //SHA1_H
@@ -0,0 +1,276 @@
+/******************************************************************************
+
+Copyright (C) 2025 Neil Richardson (nrich@neiltopia.com)
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, version 3.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+
+******************************************************************************/
+
+#include <cstring>
+#include <fstream>
+#include <type_traits>
+#include <vector>
+
+#include "SaveState.h"
+
+static_assert(std::is_trivially_copyable<SaveState>::value, "SaveState must be plain data");
+
+static const char SaveStateMagic[4] = {'M', 'G', 'T', 'S'};
+
+// magic, version and payload size
+static const size_t SaveStateHeaderSize = 12;
+
+// writes integers little endian and arrays element by element, so files don't depend on struct layout
+struct StateWriter {
+    uint8_t *position;
+
+    template<typename T>
+    void operator()(const T &value) {
+        if constexpr (std::is_integral<T>::value) {
+            for (size_t i = 0; i < sizeof(T); i++)
+                *position++ = static_cast<uint64_t>(value) >> (i * 8);
+        } else if constexpr (sizeof(value[0]) == 1) {
+            std::memcpy(position, &value[0], sizeof(value));
+            position += sizeof(value);
+        } else {
+            for (const auto &element : value)
+                (*this)(element);
+        }
+    }
+};
+
+struct StateReader {
+    const uint8_t *position;
+
+    template<typename T>
+    void operator()(T &value) {
+        if constexpr (std::is_integral<T>::value) {
+            uint64_t bits = 0;
+
+            for (size_t i = 0; i < sizeof(T); i++)
+                bits |= static_cast<uint64_t>(*position++) << (i * 8);
+
+            value = static_cast<T>(bits);
+        } else if constexpr (sizeof(value[0]) == 1) {
+            std::memcpy(&value[0], position, sizeof(value));
+            position += sizeof(value);
+        } else {
+            for (auto &element : value)
+                (*this)(element);
+        }
+    }
+};
+
+struct StateCounter {
+    size_t size = 0;
+
+    template<typename T>
+    void operator()(const T &value) {
+        size += sizeof(value);
+    }
+};
+
+/*
+    Every field of the file format in order. Adding, removing or
+    resizing one changes the format, so bump SaveState::Version.
+*/
+template<typename State, typename Visit>
+static void VisitFields(State &state, Visit &visit) {
+    visit(state.cpu.PC);
+    visit(state.cpu.period);
+    visit(state.cpu.count);
+    visit(state.cpu.request);
+    visit(state.cpu.after);
+    visit(state.cpu.backup);
+    visit(state.cpu.A);
+    visit(state.cpu.P);
+    visit(state.cpu.X);
+    visit(state.cpu.Y);
+    visit(state.cpu.S);
+
+    visit(state.lcd.bitPlanes);
+    visit(state.lcd.bitPlaneSelected);
+    visit(state.lcd.displayBlank);
+    visit(state.lcd.incrementVertical);
+    visit(state.lcd.swapBitPlanes);
+    visit(state.lcd.windowMode);
+    visit(state.lcd.noRefresh);
+    visit(state.lcd.vramAddress);
+    visit(state.lcd.xScroll);
+    visit(state.lcd.yScroll);
+
+    // all of emu2149's PSG except the volume table pointer
+    visit(state.psg.reg);
+    visit(state.psg.out);
+    visit(state.psg.cout);
+    visit(state.psg.clk);
+    visit(state.psg.rate);
+    visit(state.psg.base_incr);
+    visit(state.psg.quality);
+    visit(state.psg.count);
+    visit(state.psg.volume);
+    visit(state.psg.freq);
+    visit(state.psg.edge);
+    visit(state.psg.tmask);
+    visit(state.psg.nmask);
+    visit(state.psg.mask);
+    visit(state.psg.stereo_mask);
+    visit(state.psg.base_count);
+    visit(state.psg.env_volume);
+    visit(state.psg.env_ptr);
+    visit(state.psg.env_face);
+    visit(state.psg.env_continue);
+    visit(state.psg.env_attack);
+    visit(state.psg.env_alternate);
+    visit(state.psg.env_hold);
+    visit(state.psg.env_pause);
+    visit(state.psg.env_reset);
+    visit(state.psg.env_freq);
+    visit(state.psg.env_count);
+    visit(state.psg.noise_seed);
+    visit(state.psg.noise_count);
+    visit(state.psg.noise_freq);
+    visit(state.psg.realstep);
+    visit(state.psg.psgtime);
+    visit(state.psg.psgstep);
+    visit(state.psg.prev);
+    visit(state.psg.next);
+    visit(state.psg.sprev);
+    visit(state.psg.snext);
+    visit(state.psg.adr);
+
+    visit(state.RAM);
+    visit(state.BIOS);
+
+    visit(state.bank0_offset);
+    visit(state.bank1_offset);
+    visit(state.protection_check);
+}
+
+static size_t PayloadSize() {
+    static const size_t size = [] {
+        SaveState state = {};
+        StateCounter counter;
+        VisitFields(state, counter);
+        return counter.size;
+    }();
+
+    return size;
+}
+
+void SaveState::capture(const Gamate &gamate) {
+    gamate.cpu.saveState(cpu);
+    gamate.lcd.saveState(lcd);
+
+    // the volume table is static data owned by emu2149, not state
+    psg = gamate.psg;
+    psg.voltbl = nullptr;
+
+    RAM = gamate.running_state.RAM;
+    gamate.copyBIOS(BIOS);
+
+    bank0_offset = gamate.running_state.bank0_offset;
+    bank1_offset = gamate.running_state.bank1_offset;
+    protection_check = gamate.running_state.protection_check;
+}
+
+void SaveState::restore(Gamate &gamate) const {
+    uint32_t *voltbl = gamate.psg.voltbl;
+    gamate.psg = psg;
+    gamate.psg.voltbl = voltbl;
+
+    restoreMachine(gamate);
+}
+
+void SaveState::restoreMachine(Gamate &gamate) const {
+    gamate.restartFrame();
+    gamate.cpu.loadState(cpu);
+    gamate.lcd.loadState(lcd);
+
+    gamate.loadRAM(RAM);
+    gamate.restoreBIOS(BIOS);
+
+    gamate.running_state.bank0_offset = bank0_offset;
+    gamate.running_state.bank1_offset = bank1_offset;
+    gamate.running_state.protection_check = protection_check;
+}
+
+bool SaveState::save(const std::string &filename) const {
+    std::vector<uint8_t> buffer(SerializedSize());
+    save(buffer.data(), buffer.size());
+
+    std::ofstream fh(filename, std::ios::binary|std::ios::out|std::ios::trunc);
+
+    if (!fh)
+        return false;
+
+    fh.write(reinterpret_cast<const char*>(buffer.data()), buffer.size());
+
+    return fh.good();
+}
+
+bool SaveState::load(const std::string &filename) {
+    std::ifstream fh(filename, std::ios::binary|std::ios::in);
+
+    if (!fh)
+        return false;
+
+    std::vector<uint8_t> buffer(SerializedSize());
+
+    if (!fh.read(reinterpret_cast<char*>(buffer.data()), buffer.size()))
+        return false;
+
+    return load(buffer.data(), buffer.size());
+}
+
+size_t SaveState::SerializedSize() {
+    return SaveStateHeaderSize + PayloadSize();
+}
+
+bool SaveState::save(uint8_t *buffer, size_t size) const {
+    if (size < SerializedSize())
+        return false;
+
+    StateWriter writer = {buffer};
+    writer(SaveStateMagic);
+    writer(static_cast<uint32_t>(Version));
+    writer(static_cast<uint32_t>(PayloadSize()));
+
+    VisitFields(*this, writer);
+
+    return true;
+}
+
+bool SaveState::load(const uint8_t *buffer, size_t size) {
+    if (size < SerializedSize())
+        return false;
+
+    char magic[4];
+    uint32_t version;
+    uint32_t payload_size;
+
+    StateReader reader = {buffer};
+    reader(magic);
+    reader(version);
+    reader(payload_size);
+
+    if (std::memcmp(magic, SaveStateMagic, sizeof(magic)) || version != Version || payload_size != PayloadSize())
+        return false;
+
+    // fields not in the file, such as the volume table pointer, are left cleared
+    SaveState state = {};
+    VisitFields(state, reader);
+
+    *this = state;
+    return true;
+}
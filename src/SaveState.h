@@ -0,0 +1,68 @@
+/******************************************************************************
+
+Copyright (C) 2025 Neil Richardson (nrich@neiltopia.com)
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, version 3.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+
+******************************************************************************/
+
+#ifndef SAVESTATE_H
+#define SAVESTATE_H
+
+#include <cstdint>
+#include <cstddef>
+#include <array>
+#include <string>
+
+#include <emu2149.h>
+
+#include "CPU.h"
+#include "Gamate.h"
+#include "LCD.h"
+
+/*
+    Everything that changes while a game runs. The struct is plain data
+    so in memory snapshots are a straight copy. Files and buffers write
+    each field explicitly, little endian, behind a magic, version and
+    size header, so they don't depend on struct layout or padding.
+*/
+struct SaveState {
+    static const uint32_t Version = 2;
+
+    CPU::State cpu;
+    LCD::State lcd;
+    PSG psg;
+
+    std::array<uint8_t, 1024> RAM;
+    std::array<uint8_t, 4096> BIOS;
+
+    uint32_t bank0_offset;
+    uint32_t bank1_offset;
+    int32_t protection_check;
+
+    void capture(const Gamate &gamate);
+    void restore(Gamate &gamate) const;
+
+    // everything except the PSG, which the audio thread may be advancing
+    void restoreMachine(Gamate &gamate) const;
+
+    bool save(const std::string &filename) const;
+    bool load(const std::string &filename);
+
+    // the file format in a caller's buffer, at least SerializedSize() bytes
+    static size_t SerializedSize();
+    bool save(uint8_t *buffer, size_t size) const;
+    bool load(const uint8_t *buffer, size_t size);
+};
+
+#endif //SAVESTATE_H
@@ -0,0 +1,185 @@
+/******************************************************************************
+
+Copyright (C) 2025 Neil Richardson (nrich@neiltopia.com)
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, version 3.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+
+******************************************************************************/
+
+#ifndef SHAREDFRAMES_H
+#define SHAREDFRAMES_H
+
+#include <cstdint>
+#include <cstddef>
+#include <atomic>
+#include <string>
+#include <thread>
+
+#ifdef _WIN64
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/*
+    Layout of the shared memory a FrameServer publishes into, the only
+    header a client needs. Frames go into a ring of slots, each guarded
+    by a sequence lock: the server makes a slot's sequence odd while it
+    writes and even again when it is done, so a client reads a slot in
+    place and keeps what it read only if the sequence was even and
+    unchanged across the read. The control block is written by the
+    client and read by the server before every frame.
+
+    Every field is a fixed size integer or a lock free atomic, so the
+    layout is the same for any client built for the same architecture.
+*/
+struct SharedFrames {
+    static const uint32_t Magic = 0x4647454D; // "MEGF"
+    static const uint32_t Version = 1;
+
+    static const uint32_t Width = 160;
+    static const uint32_t Height = 150;
+    static const uint32_t RAMSize = 1024;
+
+    // about an eighth of a second at 68 frames per second
+    static const uint32_t SlotCount = 8;
+
+    struct alignas(64) Slot {
+        std::atomic<uint32_t> sequence; // odd while being written
+        uint32_t buttons; // held buttons the frame ran with, set bits as in the C API
+        uint64_t frame; // index of the frame since the server started, all ones before the first
+        uint8_t shades[Width*Height]; // 0 (lightest) to 3 (darkest) per pixel, row major
+        uint8_t RAM[RAMSize];
+    };
+
+    struct alignas(64) Control {
+        std::atomic<uint32_t> buttons; // held buttons, set bits as in the C API
+        std::atomic<uint32_t> active; // non zero while a client drives the buttons
+        std::atomic<uint32_t> lockstep; // non zero to hold each frame until consumed catches up (headless)
+        std::atomic<uint32_t> quit; // non zero to stop a headless server
+        std::atomic<uint64_t> consumed; // frames the client is finished with, for lockstep
+    };
+
+    uint32_t magic;
+    uint32_t version;
+    uint32_t slot_count;
+    uint32_t slot_size;
+
+    std::atomic<uint64_t> published; // frames published, the newest is in slot (published - 1) % SlotCount
+
+    Control control;
+    Slot slots[SlotCount];
+
+    // maps a running server's frames read write for the control block, nullptr without a compatible server
+    static SharedFrames *Attach(const std::string &name);
+    static void Detach(SharedFrames *frames);
+
+    bool compatible() const {
+        return magic == Magic && version == Version && slot_count == SlotCount && slot_size == sizeof(Slot);
+    }
+
+    /*
+        Calls read(const Slot &) on frame index in place and returns true
+        if the server did not touch the slot meanwhile, false once the
+        frame has been overwritten or is not published yet. read may see
+        a torn frame, so it should only copy or summarise what it needs
+        and act on it after a true return.
+    */
+    template<typename Read>
+    bool read(uint64_t index, Read read) const {
+        const Slot &slot = slots[index % SlotCount];
+
+        for (;;) {
+            uint32_t before = slot.sequence.load(std::memory_order_acquire);
+
+            if (before & 1) {
+                // the server only holds a slot for a copy, give it the core
+                std::this_thread::yield();
+                continue;
+            }
+
+            if (slot.frame != index) {
+                return false;
+            }
+
+            read(slot);
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+
+            if (slot.sequence.load(std::memory_order_relaxed) == before) {
+                return true;
+            }
+        }
+    }
+};
+
+inline SharedFrames *SharedFrames::Attach(const std::string &name) {
+    void *address = nullptr;
+
+#ifdef _WIN64
+    // the view keeps the mapping alive once the handle is closed
+    HANDLE mapping = OpenFileMappingA(FILE_MAP_ALL_ACCESS, FALSE, name.c_str());
+
+    if (mapping) {
+        address = MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, sizeof(SharedFrames));
+        CloseHandle(mapping);
+    }
+#else
+    int fd = shm_open(name.c_str(), O_RDWR, 0);
+
+    if (fd >= 0) {
+        struct stat info;
+
+        if (fstat(fd, &info) == 0 && (size_t)info.st_size >= sizeof(SharedFrames)) {
+            address = mmap(nullptr, sizeof(SharedFrames), PROT_READ|PROT_WRITE, MAP_SHARED, fd, 0);
+
+            if (address == MAP_FAILED)
+                address = nullptr;
+        }
+
+        close(fd);
+    }
+#endif
+
+    if (!address)
+        return nullptr;
+
+    SharedFrames *frames = static_cast<SharedFrames*>(address);
+
+    if (!frames->compatible()) {
+        Detach(frames);
+        return nullptr;
+    }
+
+    std::atomic_thread_fence(std::memory_order_acquire);
+
+    return frames;
+}
+
+inline void SharedFrames::Detach(SharedFrames *frames) {
+    if (!frames)
+        return;
+
+#ifdef _WIN64
+    UnmapViewOfFile(frames);
+#else
+    munmap(frames, sizeof(SharedFrames));
+#endif
+}
+
+static_assert(std::atomic<uint32_t>::is_always_lock_free && std::atomic<uint64_t>::is_always_lock_free, "SharedFrames atomics are shared across processes");
+
+#endif //SHAREDFRAMES_H
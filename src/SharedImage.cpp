@@ -0,0 +1,215 @@
+/******************************************************************************
+
+Copyright (C) 2025 Neil Richardson (nrich@neiltopia.com)
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, version 3.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+
+******************************************************************************/
+
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <mutex>
+
+#include <miniz.h>
+
+#include "Emulation.h"
+#include "SharedImage.h"
+
+/*
+    Loaded images by file, holding weak references so an image is freed
+    once the last instance using it lets go.
+*/
+static std::mutex store_mutex;
+static std::map<std::string, std::weak_ptr<const SharedImage>> store;
+
+SharedImage::SharedImage(std::unique_ptr<MappedFile> mapping, uint32_t checksum) : mapping(std::move(mapping)), checksum(checksum) {
+    bytes = this->mapping->data();
+    length = this->mapping->size();
+}
+
+SharedImage::SharedImage(std::vector<uint8_t> &&buffer, uint32_t checksum) : buffer(std::move(buffer)), checksum(checksum) {
+    bytes = this->buffer.data();
+    length = this->buffer.size();
+}
+
+/*
+    Decompressed images from zip files are cached on disk, keyed by the
+    CRC32 and size recorded in the zip directory, so a cache hit never
+    has to inflate anything. A hit is still checksummed against the zip
+    directory before it is used.
+*/
+static std::filesystem::path cache_file(uint32_t crc, size_t size) {
+    std::filesystem::path directory = cache_directory();
+
+    if (directory.empty())
+        return directory;
+
+    char name[48];
+    std::snprintf(name, sizeof(name), "%08x-%zu.bin", crc, size);
+
+    return directory / name;
+}
+
+static void write_cache(const std::filesystem::path &path, const uint8_t *data, size_t size) {
+    if (path.empty())
+        return;
+
+    std::error_code ec;
+    std::filesystem::create_directories(path.parent_path(), ec);
+    if (ec)
+        return;
+
+    // write then rename so a partially written file is never picked up
+    std::filesystem::path temp_path = path;
+    temp_path += ".tmp";
+
+    {
+        std::ofstream fh(temp_path, std::ios::binary|std::ios::out|std::ios::trunc);
+        fh.write(reinterpret_cast<const char*>(data), size);
+
+        if (!fh.good()) {
+            fh.close();
+            std::filesystem::remove(temp_path, ec);
+            return;
+        }
+    }
+
+    std::filesystem::rename(temp_path, path, ec);
+}
+
+static std::shared_ptr<const SharedImage> load_zip(const std::string &filename, size_t max_size, const std::string &member) {
+    mz_zip_archive zip_archive = {0};
+
+    if (!mz_zip_reader_init_file(&zip_archive, filename.c_str(), 0))
+        return nullptr;
+
+    std::shared_ptr<const SharedImage> image;
+
+    for (uint32_t i = 0; i < mz_zip_reader_get_num_files(&zip_archive); i++) {
+        mz_zip_archive_file_stat file_stat;
+
+        if (!mz_zip_reader_file_stat(&zip_archive, i, &file_stat))
+            break;
+
+        std::string lc_filename((const char*) file_stat.m_filename);
+        std::transform(lc_filename.begin(), lc_filename.end(), lc_filename.begin(), (int(*)(int)) tolower);
+        std::string extension = lc_filename.substr(lc_filename.find_last_of(".") + 1);
+
+        if (member.length() ? member == (const char*) file_stat.m_filename : extension == "bin") {
+            size_t uncomp_size = file_stat.m_uncomp_size;
+
+            if (uncomp_size == 0 || uncomp_size > max_size)
+                break;
+
+            std::filesystem::path cached = cache_file(file_stat.m_crc32, uncomp_size);
+
+            if (!cached.empty()) {
+                auto mapping = std::make_unique<MappedFile>(cached.string());
+
+                // a damaged cache file is extracted again and overwritten
+                if (mapping->valid() && mapping->size() == uncomp_size && mz_crc32(MZ_CRC32_INIT, mapping->data(), mapping->size()) == file_stat.m_crc32) {
+                    image = std::make_shared<const SharedImage>(std::move(mapping), file_stat.m_crc32);
+                    break;
+                }
+            }
+
+            // miniz checks the CRC while extracting
+            std::vector<uint8_t> buffer(uncomp_size);
+            if (mz_zip_reader_extract_to_mem(&zip_archive, i, buffer.data(), buffer.size(), 0)) {
+                write_cache(cached, buffer.data(), buffer.size());
+                image = std::make_shared<const SharedImage>(std::move(buffer), file_stat.m_crc32);
+            }
+
+            break;
+        }
+    }
+
+    mz_zip_reader_end(&zip_archive);
+    return image;
+}
+
+static std::shared_ptr<const SharedImage> load_bin(const std::string &filename, size_t max_size) {
+    auto mapping = std::make_unique<MappedFile>(filename);
+
+    if (!mapping->valid() || mapping->size() > max_size)
+        return nullptr;
+
+    uint32_t crc = mz_crc32(MZ_CRC32_INIT, mapping->data(), mapping->size());
+
+    return std::make_shared<const SharedImage>(std::move(mapping), crc);
+}
+
+std::shared_ptr<const SharedImage> SharedImage::Load(const std::string &filename, size_t max_size, const std::string &member) {
+    std::error_code ec;
+
+    std::filesystem::path path = std::filesystem::weakly_canonical(filename, ec);
+    if (ec)
+        path = filename;
+
+    auto modified = std::filesystem::last_write_time(path, ec);
+    if (ec)
+        return nullptr;
+
+    std::string key = path.string() + "|" + std::to_string(modified.time_since_epoch().count()) + "|" + std::to_string(max_size) + "|" + member;
+
+    {
+        std::lock_guard<std::mutex> lock(store_mutex);
+
+        auto it = store.find(key);
+        if (it != store.end()) {
+            if (auto image = it->second.lock())
+                return image;
+        }
+    }
+
+    std::string lc_filename = filename;
+    std::transform(lc_filename.begin(), lc_filename.end(), lc_filename.begin(), (int(*)(int)) tolower);
+    std::string extension = lc_filename.substr(lc_filename.find_last_of(".") + 1);
+
+    std::shared_ptr<const SharedImage> image = extension == "zip" ? load_zip(filename, max_size, member) : load_bin(filename, max_size);
+
+    if (!image)
+        return nullptr;
+
+    std::lock_guard<std::mutex> lock(store_mutex);
+
+    // another thread may have loaded the same file meanwhile
+    auto &entry = store[key];
+    if (auto existing = entry.lock())
+        return existing;
+
+    entry = image;
+
+    for (auto it = store.begin(); it != store.end(); ) {
+        if (it->second.expired())
+            it = store.erase(it);
+        else
+            ++it;
+    }
+
+    return image;
+}
+
+std::shared_ptr<const SharedImage> SharedImage::FromMemory(const uint8_t *data, size_t size) {
+    std::vector<uint8_t> buffer(data, data + size);
+    uint32_t crc = mz_crc32(MZ_CRC32_INIT, data, size);
+
+    return std::make_shared<const SharedImage>(std::move(buffer), crc);
+}
+
+SharedImage::~SharedImage() {
+
+}
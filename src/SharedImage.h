@@ -0,0 +1,71 @@
+/******************************************************************************
+
+Copyright (C) 2025 Neil Richardson (nrich@neiltopia.com)
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, version 3.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+
+******************************************************************************/
+
+#ifndef SHAREDIMAGE_H
+#define SHAREDIMAGE_H
+
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "MappedFile.h"
+
+/*
+    Immutable ROM or BIOS image, sized to its contents. Images are either
+    a read only mapping of the file (or of its decompressed copy in the
+    cache) or a heap buffer. Load() hands out shared references, so every
+    instance running the same file uses the same image.
+*/
+class SharedImage {
+    std::unique_ptr<MappedFile> mapping;
+    std::vector<uint8_t> buffer;
+
+    const uint8_t *bytes = nullptr;
+    size_t length = 0;
+
+    uint32_t checksum = 0;
+public:
+    SharedImage(std::unique_ptr<MappedFile> mapping, uint32_t checksum);
+    SharedImage(std::vector<uint8_t> &&buffer, uint32_t checksum);
+
+    SharedImage(const SharedImage &) = delete;
+    SharedImage &operator=(const SharedImage &) = delete;
+
+    const uint8_t *data() const {
+        return bytes;
+    }
+
+    size_t size() const {
+        return length;
+    }
+
+    // CRC32 of the contents
+    uint32_t crc() const {
+        return checksum;
+    }
+
+    // member names the file to use inside a zip, by default the first .bin
+    static std::shared_ptr<const SharedImage> Load(const std::string &filename, size_t max_size, const std::string &member = "");
+    static std::shared_ptr<const SharedImage> FromMemory(const uint8_t *data, size_t size);
+
+    ~SharedImage();
+};
+
+#endif //SHAREDIMAGE_H
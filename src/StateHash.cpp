@@ -0,0 +1,142 @@
+/******************************************************************************
+
+Copyright (C) 2025 Neil Richardson (nrich@neiltopia.com)
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, version 3.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+
+******************************************************************************/
+
+
+#include <cstring>
+
+#include "StateHash.h"
+
+// splitmix64 finaliser
+static inline uint64_t mix(uint64_t value) {
+    value ^= value >> 30;
+    value *= 0xBF58476D1CE4E5B9ull;
+    value ^= value >> 27;
+    value *= 0x94D049BB133111EBull;
+    value ^= value >> 31;
+
+    return value;
+}
+
+static uint64_t hash_bytes(const uint8_t *data, size_t size, uint64_t seed) {
+    uint64_t hash = seed;
+
+    for (size_t i = 0; i < size; i += 8) {
+        uint64_t word;
+        std::memcpy(&word, data + i, sizeof(word));
+
+        hash = (hash ^ word) * 0x9E3779B97F4A7C15ull;
+        hash = (hash << 31) | (hash >> 33);
+    }
+
+    return mix(hash ^ size);
+}
+
+// a chunk's share of the memory sum, depends on where it is as well as what
+static inline uint64_t place(uint64_t chunk_hash, size_t index) {
+    return mix(chunk_hash + index * 0xD6E8FEB86659FD93ull);
+}
+
+static uint64_t hash_registers(const CPU::State &cpu, uint64_t lcd_key, const PSG &psg, uint32_t bank0_offset, uint32_t bank1_offset, int32_t protection_check) {
+    uint64_t hash = mix(((uint64_t)cpu.PC << 48) | ((uint64_t)cpu.A << 40) | ((uint64_t)cpu.X << 32) | ((uint64_t)cpu.Y << 24) | ((uint64_t)cpu.S << 16) | ((uint64_t)cpu.P << 8) | cpu.request);
+
+    hash = mix(hash ^ (((uint64_t)(uint32_t)cpu.period << 32) | (uint32_t)cpu.count));
+    hash = mix(hash ^ (((uint64_t)(uint32_t)cpu.backup << 32) | cpu.after));
+    hash = mix(hash ^ lcd_key);
+    hash = mix(hash ^ (((uint64_t)bank0_offset << 32) | bank1_offset));
+    hash = mix(hash ^ (uint32_t)protection_check);
+
+    return hash_bytes(psg.reg, sizeof(psg.reg), hash);
+}
+
+StateHash::StateHash(Gamate &gamate) : gamate(gamate) {
+    // nothing hashed yet, so every chunk is out of date
+    gamate.touchRAM();
+    gamate.lcd.touchChunks();
+}
+
+uint64_t StateHash::hash() {
+    uint16_t dirty_ram = gamate.dirtyRAM();
+    uint64_t dirty_vram = gamate.lcd.dirtyChunks();
+
+    // a chunk never hashed yet is marked dirty, so its old share in the sum is 0
+    for (size_t chunk = 0; dirty_ram; chunk++, dirty_ram >>= 1) {
+        if (!(dirty_ram & 1))
+            continue;
+
+        uint64_t chunk_hash = place(hash_bytes(&gamate.running_state.RAM[chunk * Gamate::RAMChunkSize], Gamate::RAMChunkSize, 0), chunk);
+        memory += chunk_hash - ram_hashes[chunk];
+        ram_hashes[chunk] = chunk_hash;
+    }
+
+    for (size_t chunk = 0; dirty_vram; chunk++, dirty_vram >>= 1) {
+        if (!(dirty_vram & 1))
+            continue;
+
+        const auto &plane = gamate.lcd.bitPlane(chunk / 32);
+        uint64_t chunk_hash = place(hash_bytes(&plane[(chunk % 32) * LCD::ChunkSize], LCD::ChunkSize, 0), RAMChunks + chunk);
+        memory += chunk_hash - vram_hashes[chunk];
+        vram_hashes[chunk] = chunk_hash;
+    }
+
+    gamate.clearDirtyRAM();
+    gamate.lcd.clearDirtyChunks();
+
+    CPU::State cpu;
+    gamate.cpu.saveState(cpu);
+
+    const RunningState &state = gamate.running_state;
+
+    return mix(memory ^ hash_registers(cpu, gamate.lcd.registerKey(), gamate.psg, state.bank0_offset, state.bank1_offset, state.protection_check));
+}
+
+uint64_t StateHash::Full(const Gamate &gamate) {
+    uint64_t memory = 0;
+
+    for (size_t chunk = 0; chunk < RAMChunks; chunk++)
+        memory += place(hash_bytes(&gamate.running_state.RAM[chunk * Gamate::RAMChunkSize], Gamate::RAMChunkSize, 0), chunk);
+
+    for (size_t chunk = 0; chunk < VRAMChunks; chunk++) {
+        const auto &plane = gamate.lcd.bitPlane(chunk / 32);
+        memory += place(hash_bytes(&plane[(chunk % 32) * LCD::ChunkSize], LCD::ChunkSize, 0), RAMChunks + chunk);
+    }
+
+    CPU::State cpu;
+    gamate.cpu.saveState(cpu);
+
+    const RunningState &state = gamate.running_state;
+
+    return mix(memory ^ hash_registers(cpu, gamate.lcd.registerKey(), gamate.psg, state.bank0_offset, state.bank1_offset, state.protection_check));
+}
+
+uint64_t StateHash::Full(const SaveState &state) {
+    uint64_t memory = 0;
+
+    for (size_t chunk = 0; chunk < RAMChunks; chunk++)
+        memory += place(hash_bytes(&state.RAM[chunk * Gamate::RAMChunkSize], Gamate::RAMChunkSize, 0), chunk);
+
+    for (size_t chunk = 0; chunk < VRAMChunks; chunk++) {
+        const auto &plane = state.lcd.bitPlanes[chunk / 32];
+        memory += place(hash_bytes(&plane[(chunk % 32) * LCD::ChunkSize], LCD::ChunkSize, 0), RAMChunks + chunk);
+    }
+
+    return mix(memory ^ hash_registers(state.cpu, LCD::RegisterKey(state.lcd), state.psg, state.bank0_offset, state.bank1_offset, state.protection_check));
+}
+
+StateHash::~StateHash() {
+
+}
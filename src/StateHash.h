@@ -0,0 +1,63 @@
+/******************************************************************************
+
+Copyright (C) 2025 Neil Richardson (nrich@neiltopia.com)
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, version 3.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+
+******************************************************************************/
+
+
+#ifndef STATEHASH_H
+#define STATEHASH_H
+
+#include <cstdint>
+#include <cstddef>
+#include <array>
+
+#include "Gamate.h"
+#include "SaveState.h"
+
+/*
+    64 bit hash of everything a SaveState holds except the BIOS copy and
+    the PSG's audio side counters: CPU registers, RAM, banking, the LCD
+    bitplanes and registers and the PSG registers. RAM and VRAM are
+    hashed in chunks and only chunks written since the last hash (Gamate
+    and LCD keep dirty bits) are rehashed, so hashing after a frame costs
+    what the frame wrote rather than 17KiB. One StateHash should follow
+    a Gamate, as it clears the dirty bits it consumes. Buttons are input,
+    not state, and are left out.
+*/
+class StateHash {
+    static const size_t RAMChunks = 1024 / Gamate::RAMChunkSize;
+    static const size_t VRAMChunks = 2 * 0x2000 / LCD::ChunkSize;
+
+    Gamate &gamate;
+
+    std::array<uint64_t, RAMChunks> ram_hashes = {};
+    std::array<uint64_t, VRAMChunks> vram_hashes = {};
+
+    // sum of the position mixed chunk hashes, updated per changed chunk
+    uint64_t memory = 0;
+public:
+    StateHash(Gamate &gamate);
+
+    uint64_t hash();
+
+    // from scratch, equal to hash() for the same state
+    static uint64_t Full(const Gamate &gamate);
+    static uint64_t Full(const SaveState &state);
+
+    ~StateHash();
+};
+
+#endif //STATEHASH_H
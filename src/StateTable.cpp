@@ -0,0 +1,101 @@
+/******************************************************************************
+
+Copyright (C) 2025 Neil Richardson (nrich@neiltopia.com)
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, version 3.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+
+******************************************************************************/
+
+
+#include <algorithm>
+
+#include "StateTable.h"
+
+static inline uint64_t stored(uint64_t hash) {
+    return hash ? hash : 1;
+}
+
+StateTable::StateTable(size_t expected) {
+    size_t capacity = 16;
+
+    while (capacity < expected * 2)
+        capacity *= 2;
+
+    slots.resize(capacity, Slot{0, 0});
+}
+
+void StateTable::grow() {
+    std::vector<Slot> old(slots.size() * 2, Slot{0, 0});
+    old.swap(slots);
+
+    size_t mask = slots.size() - 1;
+
+    for (const auto &slot : old) {
+        if (!slot.hash)
+            continue;
+
+        size_t index = slot.hash & mask;
+
+        while (slots[index].hash)
+            index = (index + 1) & mask;
+
+        slots[index] = slot;
+    }
+}
+
+bool StateTable::insert(uint64_t hash, uint32_t value) {
+    if ((count + 1) * 2 > slots.size())
+        grow();
+
+    hash = stored(hash);
+
+    size_t mask = slots.size() - 1;
+    size_t index = hash & mask;
+
+    while (slots[index].hash) {
+        if (slots[index].hash == hash)
+            return false;
+
+        index = (index + 1) & mask;
+    }
+
+    slots[index] = {hash, value};
+    count++;
+
+    return true;
+}
+
+const uint32_t *StateTable::find(uint64_t hash) const {
+    hash = stored(hash);
+
+    size_t mask = slots.size() - 1;
+    size_t index = hash & mask;
+
+    while (slots[index].hash) {
+        if (slots[index].hash == hash)
+            return &slots[index].value;
+
+        index = (index + 1) & mask;
+    }
+
+    return nullptr;
+}
+
+void StateTable::clear() {
+    std::fill(slots.begin(), slots.end(), Slot{0, 0});
+    count = 0;
+}
+
+StateTable::~StateTable() {
+
+}
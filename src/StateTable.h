@@ -0,0 +1,70 @@
+/******************************************************************************
+
+Copyright (C) 2025 Neil Richardson (nrich@neiltopia.com)
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, version 3.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+
+******************************************************************************/
+
+
+#ifndef STATETABLE_H
+#define STATETABLE_H
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+/*
+    Set of state hashes for deduplicating explored states, each with a
+    32 bit value for the caller (a node index, a depth). Open addressing
+    with linear probing in a power of two table kept at most half full,
+    one 16 byte slot per state. Hash 0 marks an empty slot, a real hash
+    of 0 is stored as 1.
+*/
+class StateTable {
+    struct Slot {
+        uint64_t hash;
+        uint32_t value;
+    };
+
+    std::vector<Slot> slots;
+    size_t count = 0;
+
+    void grow();
+public:
+    StateTable(size_t expected = 1024);
+
+    // false (and value untouched) if the hash was already there
+    bool insert(uint64_t hash, uint32_t value = 0);
+
+    // nullptr if the hash is not there
+    const uint32_t *find(uint64_t hash) const;
+
+    bool contains(uint64_t hash) const {
+        return find(hash) != nullptr;
+    }
+
+    size_t size() const {
+        return count;
+    }
+
+    size_t memoryUsed() const {
+        return slots.size() * sizeof(Slot);
+    }
+
+    void clear();
+
+    ~StateTable();
+};
+
+#endif //STATETABLE_H
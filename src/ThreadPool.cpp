@@ -0,0 +1,103 @@
+/******************************************************************************
+
+Copyright (C) 2025 Neil Richardson (nrich@neiltopia.com)
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, version 3.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+
+******************************************************************************/
+
+
+#include <algorithm>
+
+#include "ThreadPool.h"
+#include "Trace.h"
+
+ThreadPool::ThreadPool(size_t thread_count) {
+    if (!thread_count)
+        thread_count = std::max<size_t>(1, std::thread::hardware_concurrency());
+
+    for (size_t i = 1; i < thread_count; i++)
+        threads.emplace_back([this]() { work(); });
+}
+
+void ThreadPool::drain() {
+    for (size_t index = next++; index < job_count; index = next++)
+        (*job)(index);
+}
+
+void ThreadPool::work() {
+    Trace::NameThread("Pool worker");
+
+    uint64_t seen = 0;
+
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            start_condition.wait(lock, [&]() { return stopping || generation != seen; });
+
+            if (stopping)
+                return;
+
+            seen = generation;
+        }
+
+        drain();
+
+        std::lock_guard<std::mutex> lock(mutex);
+
+        if (--busy == 0)
+            done_condition.notify_one();
+    }
+}
+
+void ThreadPool::run(size_t count, const std::function<void(size_t)> &fn) {
+    if (!count)
+        return;
+
+    // not worth waking anyone for one item
+    if (threads.empty() || count == 1) {
+        for (size_t index = 0; index < count; index++)
+            fn(index);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        job = &fn;
+        job_count = count;
+        next = 0;
+        busy = threads.size();
+        generation++;
+    }
+
+    start_condition.notify_all();
+
+    drain();
+
+    std::unique_lock<std::mutex> lock(mutex);
+    done_condition.wait(lock, [&]() { return busy == 0; });
+
+    job = nullptr;
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+
+    start_condition.notify_all();
+
+    for (auto &thread : threads)
+        thread.join();
+}
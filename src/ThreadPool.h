@@ -0,0 +1,73 @@
+/******************************************************************************
+
+Copyright (C) 2025 Neil Richardson (nrich@neiltopia.com)
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, version 3.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+
+******************************************************************************/
+
+
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <cstdint>
+#include <cstddef>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*
+    Fixed set of worker threads for data parallel loops. run() hands out
+    indices one at a time from an atomic counter, the calling thread
+    works too, and it returns when every index is done. The workers sleep
+    between calls, so a pool costs nothing while idle.
+*/
+class ThreadPool {
+    std::vector<std::thread> threads;
+
+    std::mutex mutex;
+    std::condition_variable start_condition;
+    std::condition_variable done_condition;
+
+    const std::function<void(size_t)> *job = nullptr;
+    size_t job_count = 0;
+    std::atomic<size_t> next{0};
+
+    size_t busy = 0;
+    uint64_t generation = 0;
+    bool stopping = false;
+
+    void work();
+    void drain();
+public:
+    // 0 for one thread per core, 1 runs everything on the caller
+    ThreadPool(size_t thread_count = 0);
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    // calls fn(i) for every i below count across the pool and waits
+    void run(size_t count, const std::function<void(size_t)> &fn);
+
+    // threads including the caller
+    size_t size() const {
+        return threads.size() + 1;
+    }
+
+    ~ThreadPool();
+};
+
+#endif //THREADPOOL_H
@@ -0,0 +1,173 @@
+/******************************************************************************
+
+Copyright (C) 2025 Neil Richardson (nrich@neiltopia.com)
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, version 3.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+
+******************************************************************************/
+
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "Trace.h"
+
+struct TraceEvent {
+    const char *name;
+    int64_t start;
+    int64_t duration;
+};
+
+/*
+    Written only by its own thread, the count is published with release
+    ordering so a save sees complete events. Buffers are never freed so
+    events from threads that have exited can still be saved.
+*/
+struct TraceBuffer {
+    std::string name;
+    uint32_t tid;
+    std::unique_ptr<TraceEvent[]> events;
+    std::atomic<uint64_t> written{0};
+};
+
+std::atomic<bool> Trace::active(false);
+
+static const auto TraceEpoch = std::chrono::steady_clock::now();
+
+static std::mutex buffers_mutex;
+static std::vector<std::unique_ptr<TraceBuffer>> buffers;
+
+static thread_local TraceBuffer *local_buffer = nullptr;
+static thread_local const char *local_name = nullptr;
+
+static TraceBuffer *thread_buffer() {
+    if (!local_buffer) {
+        auto buffer = std::make_unique<TraceBuffer>();
+        buffer->events = std::make_unique<TraceEvent[]>(Trace::Capacity);
+
+        std::lock_guard<std::mutex> lock(buffers_mutex);
+
+        buffer->tid = buffers.size() + 1;
+        buffer->name = local_name ? local_name : "Thread " + std::to_string(buffer->tid);
+
+        local_buffer = buffer.get();
+        buffers.push_back(std::move(buffer));
+    }
+
+    return local_buffer;
+}
+
+int64_t Trace::Now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - TraceEpoch).count();
+}
+
+void Trace::Record(const char *name, int64_t start, int64_t duration) {
+    TraceBuffer *buffer = thread_buffer();
+
+    uint64_t index = buffer->written.load(std::memory_order_relaxed);
+    buffer->events[index % Capacity] = {name, start, duration};
+    buffer->written.store(index + 1, std::memory_order_release);
+}
+
+void Trace::Enable(bool enable) {
+    active.store(enable, std::memory_order_relaxed);
+}
+
+void Trace::NameThread(const char *name) {
+    // the buffer, and its memory, is only created once the thread records something
+    local_name = name;
+
+    if (local_buffer) {
+        std::lock_guard<std::mutex> lock(buffers_mutex);
+        local_buffer->name = name;
+    }
+}
+
+static void write_string(std::ostream &out, const std::string &text) {
+    out << '"';
+
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            out << '\\' << c;
+        } else if ((unsigned char)c < 0x20) {
+            out << ' ';
+        } else {
+            out << c;
+        }
+    }
+
+    out << '"';
+}
+
+/*
+    Complete ("X") events with microsecond timestamps, plus a thread_name
+    metadata event per thread.
+*/
+bool Trace::Save(const std::string &filename) {
+    std::ofstream fh(filename, std::ios::out|std::ios::trunc);
+
+    if (!fh)
+        return false;
+
+    // stop new zones so the rings are not being overwritten while they are read
+    Enable(false);
+
+    std::lock_guard<std::mutex> lock(buffers_mutex);
+
+    fh << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+
+    bool first = true;
+    char number[64];
+
+    for (const auto &buffer : buffers) {
+        fh << (first ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->tid << ",\"args\":{\"name\":";
+        write_string(fh, buffer->name);
+        fh << "}}";
+        first = false;
+
+        uint64_t written = buffer->written.load(std::memory_order_acquire);
+        uint64_t oldest = written > Capacity ? written - Capacity : 0;
+
+        std::vector<TraceEvent> events;
+        events.reserve(written - oldest);
+
+        for (uint64_t i = oldest; i < written; i++) {
+            events.push_back(buffer->events[i % Capacity]);
+        }
+
+        // a thread that passed the Enabled() check just before tracing stopped may still be
+        // recording, drop every slot it could have overwritten during the copy, including the one it is writing
+        std::atomic_thread_fence(std::memory_order_acquire);
+        uint64_t rewritten = buffer->written.load(std::memory_order_relaxed) + 1;
+        size_t skip = rewritten > oldest + Capacity ? std::min<uint64_t>(rewritten - oldest - Capacity, events.size()) : 0;
+
+        for (size_t i = skip; i < events.size(); i++) {
+            const TraceEvent &event = events[i];
+
+            fh << ",\n{\"name\":";
+            write_string(fh, event.name);
+
+            std::snprintf(number, sizeof(number), ",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f", event.start / 1000.0, event.duration / 1000.0);
+            fh << number << ",\"pid\":1,\"tid\":" << buffer->tid << "}";
+        }
+    }
+
+    fh << "\n]}\n";
+
+    return fh.good();
+}
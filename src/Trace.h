@@ -0,0 +1,79 @@
+/******************************************************************************
+
+Copyright (C) 2025 Neil Richardson (nrich@neiltopia.com)
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, version 3.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+
+******************************************************************************/
+
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <cstdint>
+#include <atomic>
+#include <string>
+
+/*
+    Scoped timing zones for Chrome trace / Perfetto. Each thread records
+    into its own ring buffer, keeping the most recent events, without
+    locks. While tracing is off a zone costs one relaxed atomic load.
+    Zone names must be string literals, only the pointer is stored.
+*/
+class Trace {
+    static std::atomic<bool> active;
+
+    static int64_t Now();
+    static void Record(const char *name, int64_t start, int64_t duration);
+public:
+    // events kept per thread
+    static const size_t Capacity = 1 << 16;
+
+    class Zone {
+        const char *name;
+        int64_t start;
+    public:
+        Zone(const char *name) : name(name), start(Trace::Enabled() ? Trace::Now() : -1) {
+
+        }
+
+        Zone(const Zone &) = delete;
+        Zone &operator=(const Zone &) = delete;
+
+        // closes the zone before the end of its scope, zones still open when tracing stops are dropped
+        void end() {
+            if (start >= 0 && Trace::Enabled())
+                Trace::Record(name, start, Trace::Now() - start);
+
+            start = -1;
+        }
+
+        ~Zone() {
+            end();
+        }
+    };
+
+    static bool Enabled() {
+        return active.load(std::memory_order_relaxed);
+    }
+
+    static void Enable(bool enable);
+
+    // label for the calling thread in the trace viewer, a string literal
+    static void NameThread(const char *name);
+
+    // stops tracing and writes every thread's events as Chrome trace event JSON
+    static bool Save(const std::string &filename);
+};
+
+#endif //TRACE_H
@@ -25,6 +25,8 @@ this program. If not, see <https://www.gnu.org/licenses/>.
 #include <nfd.hpp>
 #include <license.h>
 
+#include "SaveState.h"
+#include "SharedImage.h"
 #include "UI.h"
 
 #define MEGATA_TITLE_ASCII "" \
@@ -36,14 +38,14 @@ this program. If not, see <https://www.gnu.org/licenses/>.
 "             |___/                \n"
 
 static bool show_about;
-
-extern std::array<uint8_t, 524288> ROM; // biggest rom is 512KiB
-extern std::array<uint8_t, 4096> BIOS;
-extern PSG psg;
+static bool show_library;
+static bool show_profiler;
 
 static int32_t *configured_key = nullptr;
 static int32_t *configured_button = nullptr;
 
+static std::string movie_path;
+
 static uint32_t color_to_u32(const raylib::Color &color) {
     uint8_t r = color.GetR();
     uint8_t g = color.GetG();
@@ -382,14 +384,295 @@ void UI::GamepadConfig(const std::string &text, int32_t *button) {
     }
 }
 
-bool UI::Draw(RunningState &running_state, LCD &lcd, CPU &cpu, Emulator &emulator, KeyboardInput &keyboard_input, GamepadInput &gamepad_input) {
+void UI::ResetMachine(Gamate &gamate, Rewind &rewind, Emulator &emulator) {
+    gamate.running_state.paused = !emulator.ready();
+    gamate.reset();
+    rewind.clear();
+}
+
+void UI::OpenROM(Gamate &gamate, Rewind &rewind, Emulator &emulator, const std::string &path, const std::string &member) {
+    auto image = SharedImage::Load(path, Gamate::MaxROMSize, member);
+
+    if (image) {
+        gamate.setROM(image);
+        emulator.rom = path;
+    } else {
+        std::cerr << "Could not open ROM file " << path << "\n";
+    }
+
+    ResetMachine(gamate, rewind, emulator);
+}
+
+void UI::PerfOverlay(Perf &perf) {
+    ImGui::SetNextWindowPos(ImVec2(ImGui::GetIO().DisplaySize.x - 10, 30), ImGuiCond_FirstUseEver, ImVec2(1, 0));
+    ImGui::SetNextWindowBgAlpha(0.75f);
+
+    if (ImGui::Begin("Performance", nullptr, ImGuiWindowFlags_AlwaysAutoResize | ImGuiWindowFlags_NoFocusOnAppearing)) {
+        ImGui::Text("%.2f MIPS, %.0f cycles/frame, %.1f emulated fps", perf.instructionsPerSecond() / 1e6, perf.cyclesPerFrame(), perf.emulatedFPS());
+
+        if (perf.audioRequest()) {
+            ImGui::Text("Audio: %u sample callbacks (%.1f ms), video lead %+.1f ms", perf.audioRequest(), perf.audioRequest() * 1000.0 / 44100, perf.audioLead() * 1000);
+        } else {
+            ImGui::Text("Audio: off");
+        }
+
+        if (ImGui::BeginTable("##Phases", 3, ImGuiTableFlags_SizingFixedFit)) {
+            ImGui::TableSetupColumn("Phase");
+            ImGui::TableSetupColumn("Avg ms");
+            ImGui::TableSetupColumn("Max ms");
+            ImGui::TableHeadersRow();
+
+            for (int phase = 0; phase < Perf::PhaseCount; phase++) {
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn();
+                ImGui::TextUnformatted(Perf::PhaseName((Perf::Phase)phase));
+                ImGui::TableNextColumn();
+                ImGui::Text("%.3f", perf.phaseAverage((Perf::Phase)phase));
+                ImGui::TableNextColumn();
+                ImGui::Text("%.3f", perf.phaseMax((Perf::Phase)phase));
+            }
+
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted("Frame");
+            ImGui::TableNextColumn();
+            ImGui::Text("%.3f", perf.frameAverage());
+            ImGui::TableNextColumn();
+            ImGui::Text("%.3f", perf.frameMax());
+
+            ImGui::EndTable();
+        }
+
+        int count = perf.historyCount();
+        int offset = count < (int)Perf::HistorySize ? 0 : perf.historyOffset();
+
+        ImGui::PlotHistogram("##Frame", perf.frameHistory(), count, offset, "Frame time (ms)", 0.0f, std::max(perf.frameMax(), 1000.0f / 60), ImVec2(360, 60));
+        ImGui::PlotLines("##Emulate", perf.phaseHistory(Perf::Emulate), count, offset, "Emulate (ms)", 0.0f, std::max(perf.phaseMax(Perf::Emulate), 1.0f), ImVec2(360, 40));
+    }
+
+    ImGui::End();
+}
+
+void UI::ProfilerWindow(Gamate &gamate, Profiler &profiler) {
+    static std::vector<Profiler::Hotspot> hotspots;
+    static int32_t refresh = 0;
+
+    ImGui::SetNextWindowSize(ImVec2(560, 400), ImGuiCond_FirstUseEver);
+
+    if (ImGui::Begin("Profiler", &show_profiler)) {
+        bool enabled = profiler.enabled();
+
+        if (ImGui::Checkbox("Enabled", &enabled)) {
+            if (enabled)
+                profiler.enable(gamate);
+            else
+                profiler.disable();
+        }
+
+        ImGui::SameLine();
+
+        if (ImGui::Button("Reset")) {
+            profiler.reset();
+            refresh = 0;
+        }
+
+        ImGui::SameLine();
+
+        if (ImGui::Button("Save Report")) {
+            bool is_audio_enabled = gamate.running_state.audio_enabled;
+            gamate.running_state.audio_enabled = false;
+
+            NFD::UniquePath out_path;
+
+            nfdu8filteritem_t filters[1] = {{"Text", "txt"}};
+
+            nfdresult_t result = NFD::SaveDialog(out_path, filters, 1, nullptr, "profile.txt");
+
+            gamate.running_state.audio_enabled = is_audio_enabled;
+
+            if (result == NFD_OKAY) {
+                profiler.save(out_path.get(), 1000);
+            }
+        }
+
+        ImGui::Text("%llu instructions, %llu cycles", (unsigned long long)profiler.instructions(), (unsigned long long)profiler.cycles());
+
+        // sorting every location each frame is wasteful, twice a second is plenty
+        if (refresh-- <= 0) {
+            hotspots = profiler.hotspots(100);
+            refresh = 30;
+        }
+
+        ImGuiTableFlags flags = ImGuiTableFlags_RowBg | ImGuiTableFlags_ScrollY | ImGuiTableFlags_Resizable | ImGuiTableFlags_BordersInnerV;
+
+        if (ImGui::BeginTable("##Hotspots", 5, flags)) {
+            ImGui::TableSetupScrollFreeze(0, 1);
+            ImGui::TableSetupColumn("Location", ImGuiTableColumnFlags_WidthFixed);
+            ImGui::TableSetupColumn("Instructions", ImGuiTableColumnFlags_WidthFixed);
+            ImGui::TableSetupColumn("Cycles", ImGuiTableColumnFlags_WidthFixed);
+            ImGui::TableSetupColumn("%", ImGuiTableColumnFlags_WidthFixed);
+            ImGui::TableSetupColumn("Disassembly", ImGuiTableColumnFlags_WidthStretch);
+            ImGui::TableHeadersRow();
+
+            for (const auto &hotspot : hotspots) {
+                ImGui::TableNextRow();
+
+                ImGui::TableNextColumn();
+                ImGui::TextUnformatted(Profiler::Location(hotspot).c_str());
+
+                ImGui::TableNextColumn();
+                ImGui::Text("%llu", (unsigned long long)hotspot.instructions);
+
+                ImGui::TableNextColumn();
+                ImGui::Text("%llu", (unsigned long long)hotspot.cycles);
+
+                ImGui::TableNextColumn();
+                ImGui::Text("%.2f", hotspot.share*100.0);
+
+                ImGui::TableNextColumn();
+                ImGui::TextUnformatted(hotspot.disassembly.c_str());
+            }
+
+            ImGui::EndTable();
+        }
+    }
+
+    ImGui::End();
+}
+
+void UI::LibraryWindow(Gamate &gamate, Rewind &rewind, Movie &movie, Library &library, Emulator &emulator) {
+    static ImGuiTextFilter filter;
+
+    ImGui::SetNextWindowSize(ImVec2(640, 400), ImGuiCond_FirstUseEver);
+
+    if (ImGui::Begin("Library", &show_library)) {
+        if (ImGui::Button("Choose Folder")) {
+            bool is_audio_enabled = gamate.running_state.audio_enabled;
+            gamate.running_state.audio_enabled = false;
+
+            NFD::UniquePath out_path;
+
+            nfdresult_t result = NFD::PickFolder(out_path);
+
+            gamate.running_state.audio_enabled = is_audio_enabled;
+
+            if (result == NFD_OKAY) {
+                library.setDirectory(out_path.get());
+                library.scan();
+            }
+        }
+
+        ImGui::SameLine();
+
+        ImGui::BeginDisabled(library.scanning() || library.directory().empty());
+        if (ImGui::Button("Rescan")) {
+            library.scan();
+        }
+        ImGui::EndDisabled();
+
+        ImGui::SameLine();
+
+        if (library.scanning()) {
+            ImGui::Text("Scanning %zu/%zu", library.scanProgress(), library.scanTotal());
+        } else {
+            ImGui::TextUnformatted(library.directory().length() ? library.directory().c_str() : "No folder chosen");
+        }
+
+        filter.Draw("Filter");
+
+        auto entries = library.list();
+
+        ImGuiTableFlags flags = ImGuiTableFlags_RowBg | ImGuiTableFlags_ScrollY | ImGuiTableFlags_Resizable | ImGuiTableFlags_BordersInnerV;
+
+        if (ImGui::BeginTable("##Entries", 4, flags)) {
+            ImGui::TableSetupScrollFreeze(0, 1);
+            ImGui::TableSetupColumn("Title", ImGuiTableColumnFlags_WidthStretch);
+            ImGui::TableSetupColumn("Size", ImGuiTableColumnFlags_WidthFixed);
+            ImGui::TableSetupColumn("Mapper", ImGuiTableColumnFlags_WidthFixed);
+            ImGui::TableSetupColumn("CRC32", ImGuiTableColumnFlags_WidthFixed);
+            ImGui::TableHeadersRow();
+
+            for (const auto &entry : *entries) {
+                if (!filter.PassFilter(entry.title.c_str()))
+                    continue;
+
+                ImGui::PushID(&entry);
+                ImGui::TableNextRow();
+
+                ImGui::TableNextColumn();
+                if (ImGui::Selectable(entry.title.c_str(), false, ImGuiSelectableFlags_SpanAllColumns | ImGuiSelectableFlags_AllowDoubleClick) && ImGui::IsMouseDoubleClicked(ImGuiMouseButton_Left) && !movie.active()) {
+                    OpenROM(gamate, rewind, emulator, entry.path, entry.member);
+                }
+                if (ImGui::IsItemHovered()) {
+                    ImGui::SetTooltip("%s%s%s%s", entry.path.c_str(), entry.member.length() ? " : " : "", entry.member.c_str(), entry.known ? "" : "\nNot in the ROM database");
+                }
+
+                ImGui::TableNextColumn();
+                ImGui::Text("%u KiB", entry.size / 1024);
+
+                ImGui::TableNextColumn();
+                ImGui::TextUnformatted(Library::MapperName(entry.mapper));
+
+                ImGui::TableNextColumn();
+                ImGui::Text("%08X", entry.crc);
+
+                ImGui::PopID();
+            }
+
+            ImGui::EndTable();
+        }
+    }
+
+    ImGui::End();
+}
+
+void UI::SaveStateFile(Gamate &gamate, Emulator &emulator) {
+    if (!emulator.ready())
+        return;
+
+    SaveState state = {};
+    state.capture(gamate);
+
+    if (!state.save(emulator.statePath())) {
+        std::cerr << "Could not write state file " << emulator.statePath() << "\n";
+    }
+}
+
+void UI::LoadStateFile(Gamate &gamate, Emulator &emulator) {
+    if (!emulator.ready())
+        return;
+
+    SaveState state;
+
+    if (state.load(emulator.statePath())) {
+        state.restore(gamate);
+    } else {
+        std::cerr << "Could not read state file " << emulator.statePath() << "\n";
+    }
+}
+
+bool UI::Draw(Gamate &gamate, Rewind &rewind, Movie &movie, Library &library, Capture &capture, Perf &perf, Profiler &profiler, InstructionTrace &instruction_trace, DebugView &debug_view, CheatView &cheat_view, Emulator &emulator, KeyboardInput &keyboard_input, GamepadInput &gamepad_input) {
+    RunningState &running_state = gamate.running_state;
     bool should_exit = false;
 
+    if (IsKeyPressed(KEY_F5)) {
+        SaveStateFile(gamate, emulator);
+    }
+
+    if (IsKeyPressed(KEY_F9) && !movie.active()) {
+        LoadStateFile(gamate, emulator);
+        rewind.clear();
+    }
+
+    if (IsKeyPressed(KEY_F12)) {
+        capture.screenshot(gamate.lcd, emulator.palette, emulator.capturePath(".png"), emulator.scale);
+    }
+
     rlImGuiBegin();
     {
         if (ImGui::BeginMainMenuBar()) {
             if (ImGui::BeginMenu("File")) {
-                if (ImGui::MenuItem("Open ROM")) {
+                if (ImGui::MenuItem("Open ROM", "", false, !movie.active())) {
                     bool is_audio_enabled = running_state.audio_enabled;
                     running_state.audio_enabled = false;
 
@@ -400,27 +683,16 @@ bool UI::Draw(RunningState &running_state, LCD &lcd, CPU &cpu, Emulator &emulato
                     nfdresult_t result = NFD::OpenDialog(out_path, filters);
 
                     if (result == NFD_OKAY) {
-                        std::string rom_path = out_path.get();
-
-                        ROM = {0};
-                        if (load_file(rom_path, ROM.data(), ROM.size())) {
-                            emulator.rom = rom_path;
-                        } else {
-                            std::cerr << "Could not open ROM file " << rom_path << "\n";
-                        }
-
-                        PSG_reset(&psg);
-
-                        running_state.reset(!emulator.ready(), is_audio_enabled);
-                        lcd.reset();
-
-                        cpu.reset();
-                        cpu.setPeriod(32768);
+                        running_state.audio_enabled = is_audio_enabled;
+                        OpenROM(gamate, rewind, emulator, out_path.get(), "");
                     } else {
                         running_state.audio_enabled = is_audio_enabled;
                     }
                 }
-                if (ImGui::MenuItem("Load BIOS")) {
+                if (ImGui::MenuItem("Library")) {
+                    show_library = true;
+                }
+                if (ImGui::MenuItem("Load BIOS", "", false, !movie.active())) {
                     bool is_audio_enabled = running_state.audio_enabled;
                     running_state.audio_enabled = false;
 
@@ -433,25 +705,126 @@ bool UI::Draw(RunningState &running_state, LCD &lcd, CPU &cpu, Emulator &emulato
                     if (result == NFD_OKAY) {
                         std::string bios_path = out_path.get();
 
-                        ROM = {0};
-                        if (load_file(bios_path, BIOS.data(), BIOS.size())) {
+                        auto image = SharedImage::Load(bios_path, Gamate::BIOSSize);
+
+                        if (image) {
+                            gamate.setBIOS(image);
                             emulator.bios = bios_path;
                         } else {
                             std::cerr << "Could not open BIOS file " << bios_path << "\n";
                         }
 
-                        PSG_reset(&psg);
-
-                        running_state.reset(!emulator.ready(), is_audio_enabled);
-                        lcd.reset();
-
-                        cpu.reset();
-                        cpu.setPeriod(32768);
+                        running_state.paused = !emulator.ready();
+                        running_state.audio_enabled = is_audio_enabled;
+                        gamate.reset();
+                        rewind.clear();
                     } else {
                         running_state.audio_enabled = is_audio_enabled;
                     }
                 }
 
+                ImGui::Separator();
+
+                if (ImGui::MenuItem("Save State", "F5", false, emulator.ready())) {
+                    SaveStateFile(gamate, emulator);
+                }
+                if (ImGui::MenuItem("Load State", "F9", false, emulator.ready() && !movie.active())) {
+                    LoadStateFile(gamate, emulator);
+                    rewind.clear();
+                }
+
+                ImGui::Separator();
+
+                if (ImGui::MenuItem("Screenshot", "F12")) {
+                    capture.screenshot(gamate.lcd, emulator.palette, emulator.capturePath(".png"), emulator.scale);
+                }
+
+                if (capture.recording()) {
+                    if (ImGui::MenuItem("Stop Video")) {
+                        capture.stopVideo();
+                    }
+                } else if (ImGui::MenuItem("Record Video")) {
+                    bool is_audio_enabled = running_state.audio_enabled;
+                    running_state.audio_enabled = false;
+
+                    NFD::UniquePath out_path;
+
+                    nfdu8filteritem_t filters[1] = {{"YUV4MPEG2", "y4m"}};
+
+                    std::string default_name = std::filesystem::path(emulator.capturePath(".y4m")).filename().string();
+                    nfdresult_t result = NFD::SaveDialog(out_path, filters, 1, nullptr, default_name.c_str());
+
+                    running_state.audio_enabled = is_audio_enabled;
+
+                    if (result == NFD_OKAY) {
+                        capture.startVideo(out_path.get(), emulator.scale);
+                    }
+                }
+
+                ImGui::Separator();
+
+                if (movie.recording()) {
+                    if (ImGui::MenuItem("Stop Recording")) {
+                        movie.stop();
+
+                        if (!movie.save(movie_path)) {
+                            std::cerr << "Could not write movie file " << movie_path << "\n";
+                        }
+                    }
+                } else if (ImGui::MenuItem("Record Movie", "", false, emulator.ready())) {
+                    bool is_audio_enabled = running_state.audio_enabled;
+                    running_state.audio_enabled = false;
+
+                    NFD::UniquePath out_path;
+
+                    nfdu8filteritem_t filters[1] = {{"Movie", "mgm"}};
+
+                    nfdresult_t result = NFD::SaveDialog(out_path, filters, 1, nullptr, "movie.mgm");
+
+                    running_state.audio_enabled = is_audio_enabled;
+
+                    if (result == NFD_OKAY) {
+                        movie_path = out_path.get();
+
+                        ResetMachine(gamate, rewind, emulator);
+                        movie.startRecording(gamate.romImage()->crc(), gamate.biosImage()->crc());
+                    }
+                }
+
+                if (movie.playing()) {
+                    if (ImGui::MenuItem("Stop Playback")) {
+                        movie.stop();
+                    }
+                } else if (ImGui::MenuItem("Play Movie", "", false, emulator.ready() && !movie.recording())) {
+                    bool is_audio_enabled = running_state.audio_enabled;
+                    running_state.audio_enabled = false;
+
+                    NFD::UniquePath out_path;
+
+                    nfdu8filteritem_t filters[1] = {{"Movie", "mgm"}};
+
+                    nfdresult_t result = NFD::OpenDialog(out_path, filters, 1);
+
+                    running_state.audio_enabled = is_audio_enabled;
+
+                    if (result == NFD_OKAY) {
+                        std::string path = out_path.get();
+
+                        if (!movie.load(path)) {
+                            std::cerr << "Could not open movie file " << path << "\n";
+                        } else {
+                            if (movie.romCRC() != gamate.romImage()->crc() || movie.biosCRC() != gamate.biosImage()->crc()) {
+                                std::cerr << "Movie " << path << " was recorded with a different ROM or BIOS\n";
+                            }
+
+                            ResetMachine(gamate, rewind, emulator);
+                            movie.startPlayback();
+                        }
+                    }
+                }
+
+                ImGui::Separator();
+
                 if (ImGui::MenuItem("Quit", "ESC")) {
                     should_exit = true;
                 }
@@ -511,6 +884,8 @@ bool UI::Draw(RunningState &running_state, LCD &lcd, CPU &cpu, Emulator &emulato
                     KeyboardConfig("Button B:", &keyboard_input.b);
                     KeyboardConfig("Start:", &keyboard_input.start);
                     KeyboardConfig("Select:", &keyboard_input.select);
+                    KeyboardConfig("Rewind:", &keyboard_input.rewind);
+                    KeyboardConfig("Fast Forward:", &keyboard_input.fast_forward);
 
                     KeyboardPopup();
 
@@ -534,12 +909,65 @@ bool UI::Draw(RunningState &running_state, LCD &lcd, CPU &cpu, Emulator &emulato
                 if (ImGui::MenuItem("Pause", "", &running_state.paused)) {
                     running_state.audio_enabled = !running_state.paused;
                 }
-                if (ImGui::MenuItem("Reset")) {
-                    running_state.reset(!emulator.ready(), running_state.audio_enabled);
-                    lcd.reset();
+                if (ImGui::MenuItem("Reset", "", false, !movie.active())) {
+                    ResetMachine(gamate, rewind, emulator);
+                }
+                if (ImGui::MenuItem("Fast Forward", "", &emulator.fast_forward)) {
+                }
+                if (ImGui::MenuItem("Pause In Background", "", &emulator.pause_unfocused)) {
+                }
+                if (ImGui::MenuItem("Performance Overlay", "", &emulator.show_perf)) {
+                }
+                cheat_view.menu();
+                if (ImGui::BeginMenu("Run Ahead")) {
+                    if (ImGui::MenuItem("Off", "", emulator.run_ahead == 0)) {
+                        emulator.run_ahead = 0;
+                    }
+                    if (ImGui::MenuItem("1 Frame", "", emulator.run_ahead == 1)) {
+                        emulator.run_ahead = 1;
+                    }
+                    if (ImGui::MenuItem("2 Frames", "", emulator.run_ahead == 2)) {
+                        emulator.run_ahead = 2;
+                    }
+                    ImGui::EndMenu();
+                }
+                if (rewind.enabled()) {
+                    ImGui::Separator();
+                    ImGui::Text("Rewind: %.1fs (%zu KiB)", rewind.frameCount() / 68.0, rewind.memoryUsed() / 1024);
+                }
+                ImGui::EndMenu();
+            }
+
+            if (ImGui::BeginMenu("Debug")) {
+                debug_view.menu();
+
+                ImGui::Separator();
+
+                if (ImGui::MenuItem("Profiler", "", &show_profiler)) {
+                }
+                if (ImGui::MenuItem("Instruction Trace", "", instruction_trace.enabled())) {
+                    if (instruction_trace.enabled()) {
+                        instruction_trace.disable();
+                    } else {
+                        instruction_trace.clear();
+                        instruction_trace.enable(gamate);
+                    }
+                }
+                if (ImGui::MenuItem("Save Instruction Trace", "", false, instruction_trace.size() > 0)) {
+                    bool is_audio_enabled = running_state.audio_enabled;
+                    running_state.audio_enabled = false;
 
-                    cpu.reset();
-                    cpu.setPeriod(32768);
+                    NFD::UniquePath out_path;
+
+                    nfdu8filteritem_t filters[1] = {{"Instruction Trace", "bin"}};
+
+                    nfdresult_t result = NFD::SaveDialog(out_path, filters, 1, nullptr, "itrace.bin");
+
+                    running_state.audio_enabled = is_audio_enabled;
+
+                    if (result == NFD_OKAY && !instruction_trace.save(out_path.get())) {
+                        std::cerr << "Could not write instruction trace " << out_path.get() << "\n";
+                    }
                 }
                 ImGui::EndMenu();
             }
@@ -552,8 +980,29 @@ bool UI::Draw(RunningState &running_state, LCD &lcd, CPU &cpu, Emulator &emulato
                 ImGui::EndMenu();
             }
 
+            if (capture.recording()) {
+                ImGui::Separator();
+                ImGui::Text("REC %.1fs", capture.videoFrames() / (double(CPUClock) / FrameCycles));
+            }
+
+            if (running_state.fast_forward) {
+                ImGui::Separator();
+                ImGui::Text("Fast Forward %.1fx", running_state.speed);
+            }
+
             ImGui::EndMainMenuBar();
         }
+        if (emulator.show_perf) {
+            PerfOverlay(perf);
+        }
+        if (show_library) {
+            LibraryWindow(gamate, rewind, movie, library, emulator);
+        }
+        if (show_profiler) {
+            ProfilerWindow(gamate, profiler);
+        }
+        debug_view.draw();
+        cheat_view.draw(emulator);
         if (show_about) {
             ImGui::OpenPopup("About Megate");
 
@@ -21,9 +21,17 @@ this program. If not, see <https://www.gnu.org/licenses/>.
 
 #include <cstdint>
 
-#include "CPU.h"
+#include "Capture.h"
+#include "CheatView.h"
+#include "DebugView.h"
 #include "Emulation.h"
-#include "LCD.h"
+#include "Gamate.h"
+#include "InstructionTrace.h"
+#include "Library.h"
+#include "Movie.h"
+#include "Perf.h"
+#include "Profiler.h"
+#include "Rewind.h"
 
 class UI {
     static void KeyboardPopup();
@@ -36,8 +44,20 @@ class UI {
     static std::string KeyboardKeyToName(const KeyboardKey key);
 
     static std::string GamepadButtonToName(int32_t button);
+
+    static void ResetMachine(Gamate &gamate, Rewind &rewind, Emulator &emulator);
+    static void OpenROM(Gamate &gamate, Rewind &rewind, Emulator &emulator, const std::string &path, const std::string &member);
+
+    static void PerfOverlay(Perf &perf);
+
+    static void ProfilerWindow(Gamate &gamate, Profiler &profiler);
+
+    static void LibraryWindow(Gamate &gamate, Rewind &rewind, Movie &movie, Library &library, Emulator &emulator);
+
+    static void SaveStateFile(Gamate &gamate, Emulator &emulator);
+    static void LoadStateFile(Gamate &gamate, Emulator &emulator);
 public:
-    static bool Draw(RunningState &running_state, LCD &lcd, CPU &cpu, Emulator &emulator, KeyboardInput &keyboard_input, GamepadInput &gamepad_input);
+    static bool Draw(Gamate &gamate, Rewind &rewind, Movie &movie, Library &library, Capture &capture, Perf &perf, Profiler &profiler, InstructionTrace &instruction_trace, DebugView &debug_view, CheatView &cheat_view, Emulator &emulator, KeyboardInput &keyboard_input, GamepadInput &gamepad_input);
 };
 
 #endif //UI_H
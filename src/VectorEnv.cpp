@@ -0,0 +1,129 @@
+/******************************************************************************
+
+Copyright (C) 2025 Neil Richardson (nrich@neiltopia.com)
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, version 3.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+
+******************************************************************************/
+
+
+#include <algorithm>
+
+#include "VectorEnv.h"
+
+static const uint8_t GreyLevels[4] = {0xFF, 0xAA, 0x55, 0x00};
+
+VectorEnv::VectorEnv(size_t count, std::shared_ptr<const SharedImage> rom, std::shared_ptr<const SharedImage> bios, size_t threads) : pool(threads) {
+    environments.resize(count);
+    observation_buffer.resize(count * ObservationSize);
+    done_flags.resize(count, 0);
+
+    for (auto &environment : environments) {
+        environment.gamate = std::make_unique<Gamate>();
+        environment.gamate->setROM(rom);
+        environment.gamate->setBIOS(bios);
+    }
+
+    reset();
+}
+
+void VectorEnv::setOptions(const Options &new_options) {
+    options = new_options;
+    options.frame_skip = std::max(options.frame_skip, 1);
+
+    for (size_t i = 0; i < environments.size(); i++)
+        observe(environments[i], observation_buffer.data() + i * ObservationSize, false);
+}
+
+void VectorEnv::setStartState(const SaveState &state) {
+    start_state = std::make_unique<SaveState>(state);
+}
+
+void VectorEnv::clearStartState() {
+    start_state.reset();
+}
+
+void VectorEnv::restart(Environment &environment) {
+    Gamate &gamate = *environment.gamate;
+
+    if (start_state) {
+        start_state->restore(gamate);
+    } else {
+        gamate.reset();
+    }
+
+    gamate.running_state.paused = false;
+    environment.episode_frames = 0;
+}
+
+void VectorEnv::observe(const Environment &environment, uint8_t *out, bool pool_previous) const {
+    environment.gamate->lcd.render(out);
+
+    if (pool_previous) {
+        for (size_t i = 0; i < ObservationSize; i++)
+            out[i] = std::max(out[i], environment.pooled[i]);
+    }
+
+    if (options.observation == Greyscale) {
+        for (size_t i = 0; i < ObservationSize; i++)
+            out[i] = GreyLevels[out[i]];
+    }
+}
+
+void VectorEnv::stepOne(size_t index, uint8_t buttons) {
+    Environment &environment = environments[index];
+    Gamate &gamate = *environment.gamate;
+    uint8_t *out = observation_buffer.data() + index * ObservationSize;
+
+    bool pool_previous = options.max_pool && options.frame_skip > 1;
+
+    // the hardware reads held buttons as 0 bits
+    gamate.running_state.button_state = ~buttons;
+
+    for (int32_t frame = 0; frame < options.frame_skip; frame++) {
+        if (pool_previous && frame == options.frame_skip - 1)
+            gamate.lcd.render(environment.pooled.data());
+
+        gamate.runFrame();
+    }
+
+    environment.episode_frames += options.frame_skip;
+
+    if (options.max_episode_frames && environment.episode_frames >= options.max_episode_frames) {
+        restart(environment);
+        done_flags[index] = 1;
+        observe(environment, out, false);
+        return;
+    }
+
+    done_flags[index] = 0;
+    observe(environment, out, pool_previous);
+}
+
+void VectorEnv::step(const uint8_t *buttons) {
+    pool.run(environments.size(), [this, buttons](size_t index) { stepOne(index, buttons[index]); });
+}
+
+void VectorEnv::reset() {
+    pool.run(environments.size(), [this](size_t index) { reset(index); });
+}
+
+void VectorEnv::reset(size_t index) {
+    restart(environments[index]);
+    done_flags[index] = 0;
+    observe(environments[index], observation_buffer.data() + index * ObservationSize, false);
+}
+
+VectorEnv::~VectorEnv() {
+
+}
@@ -0,0 +1,133 @@
+/******************************************************************************
+
+Copyright (C) 2025 Neil Richardson (nrich@neiltopia.com)
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, version 3.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+
+******************************************************************************/
+
+
+#ifndef VECTORENV_H
+#define VECTORENV_H
+
+#include <cstdint>
+#include <cstddef>
+#include <array>
+#include <memory>
+#include <vector>
+
+#include "Gamate.h"
+#include "LCD.h"
+#include "SaveState.h"
+#include "SharedImage.h"
+#include "ThreadPool.h"
+
+/*
+    A batch of consoles stepped together for reinforcement learning. One
+    step() takes a button mask per environment, runs frame_skip frames on
+    each across a thread pool and leaves the observations in one
+    contiguous [count, 150, 160] byte array, as shades (0-3) or
+    greyscale, optionally the maximum of the last two frames to hide
+    flicker. An environment whose episode reached its frame limit (or
+    was reset by the caller) starts over in the same step, its observation
+    is then the first of the new episode. Pooling keeps the darker shade.
+    All instances share the ROM and BIOS images.
+*/
+class VectorEnv {
+public:
+    enum Observation : uint8_t {
+        Shades,
+        Greyscale,
+    };
+
+    struct Options {
+        int32_t frame_skip;
+        bool max_pool; // over the last two frames of a skip
+        Observation observation;
+        uint32_t max_episode_frames; // 0 for no limit
+    };
+
+    static const size_t ObservationSize = LCD::ScreenWidth * LCD::ScreenHeight;
+private:
+    struct Environment {
+        std::unique_ptr<Gamate> gamate;
+        uint32_t episode_frames;
+        std::array<uint8_t, ObservationSize> pooled;
+    };
+
+    std::vector<Environment> environments;
+
+    Options options = {1, false, Shades, 0};
+
+    // episodes start from here when set, otherwise from power on
+    std::unique_ptr<SaveState> start_state;
+
+    std::vector<uint8_t> observation_buffer;
+    std::vector<uint8_t> done_flags;
+
+    ThreadPool pool;
+
+    void restart(Environment &environment);
+    void observe(const Environment &environment, uint8_t *out, bool pool_previous) const;
+    void stepOne(size_t index, uint8_t buttons);
+public:
+    // threads 0 for one per core
+    VectorEnv(size_t count, std::shared_ptr<const SharedImage> rom, std::shared_ptr<const SharedImage> bios, size_t threads = 0);
+
+    VectorEnv(const VectorEnv &) = delete;
+    VectorEnv &operator=(const VectorEnv &) = delete;
+
+    void setOptions(const Options &new_options);
+
+    const Options &getOptions() const {
+        return options;
+    }
+
+    // a state to start episodes from, e.g. past the title screen
+    void setStartState(const SaveState &state);
+    void clearStartState();
+
+    // one button mask per environment, set bits are held: up, down, left,
+    // right, A, B, start and select from bit 0
+    void step(const uint8_t *buttons);
+
+    void reset();
+
+    // e.g. when a reward function sees a game over
+    void reset(size_t index);
+
+    size_t size() const {
+        return environments.size();
+    }
+
+    size_t threads() const {
+        return pool.size();
+    }
+
+    const uint8_t *observations() const {
+        return observation_buffer.data();
+    }
+
+    // 1 for environments reset by the last step
+    const uint8_t *dones() const {
+        return done_flags.data();
+    }
+
+    Gamate &instance(size_t index) {
+        return *environments[index].gamate;
+    }
+
+    ~VectorEnv();
+};
+
+#endif //VECTORENV_H
@@ -25,9 +25,12 @@ this program. If not, see <https://www.gnu.org/licenses/>.
 #include <algorithm>
 #include <vector>
 #include <iomanip>
+#include <sstream>
 #include <thread>
 #include <memory>
 #include <filesystem>
+#include <chrono>
+#include <csignal>
 
 #include <raylib-cpp.hpp>
 #include <cmdline.h>
@@ -36,212 +39,304 @@ this program. If not, see <https://www.gnu.org/licenses/>.
 #include <imgui.h>
 #include <rlImGui.h>
 
+#include "Capture.h"
+#include "Cheats.h"
+#include "CheatSearch.h"
+#include "CheatView.h"
 #include "CPU.h"
+#include "DebugView.h"
+#include "Debugger.h"
 #include "LCD.h"
 #include "Emulation.h"
+#include "Explorer.h"
+#include "FrameServer.h"
+#include "Gamate.h"
+#include "InstructionTrace.h"
+#include "Library.h"
+#include "Movie.h"
+#include "Pacer.h"
+#include "Perf.h"
+#include "Profiler.h"
+#include "Regression.h"
+#include "Rewind.h"
+#include "SaveState.h"
+#include "SharedImage.h"
+#include "StateTable.h"
+#include "Trace.h"
 #include "UI.h"
 
-std::array<uint8_t, 524288> ROM; // biggest rom is 512KiB
-std::array<uint8_t, 4096> BIOS;
+static Gamate gamate;
 
-static LCD lcd;
-
-PSG psg;
-
-static RunningState running_state;
 static KeyboardInput keyboard_input;
 static GamepadInput gamepad_input;
 
+static SaveState rewind_state;
+static SaveState run_ahead_state;
+
+static Pacer pacer(44100);
+
+static Library library;
+
+static Capture capture;
+
+static Perf perf;
+static Profiler profiler;
+static Debugger debugger;
+static DebugView debug_view(gamate, debugger);
+static Cheats cheats;
+static CheatSearch cheat_search;
+static CheatView cheat_view(gamate, cheats, cheat_search);
+static std::unique_ptr<InstructionTrace> instruction_trace;
+static FrameServer frame_server;
+
+// set from the signal handler to stop a headless server cleanly
+static volatile std::sig_atomic_t server_stopping = 0;
+
+static const std::chrono::microseconds FastForwardBudget(1000000 * 3 / (4 * 68));
+
 extern Palette green_palette;
 extern Palette grey_palette;
 extern Palette gb_palette;
 extern Palette gbp_palette;
 
-uint8_t read6502(uint16_t address) {
-    if (address >= 0x0000 && address <= 0x1FFF) {
-        // 1KiB RAM mirrored 8 times
-        return running_state.RAM[address & 0x03FF];
-    }
+static int run_explore(cmdline::parser &argparser) {
+    std::string explore_path = argparser.get<std::string>("explore");
+    std::vector<Explorer::Sequence> sequences;
 
-    if (address >= 0x2000 && address <= 0x3FFF) {
-        // peripheral space
-        return 0xFF;
+    if (!Explorer::LoadSequences(explore_path, sequences)) {
+        std::cerr << "Could not read input sequences " << explore_path << "\n";
+        return -1;
     }
 
-    if (address >= 0x4000 && address <= 0x43FF) {
-        // audio
-        return 0xFF;
-    }
+    std::string mode_name = argparser.get<std::string>("explore-mode");
 
-    if (address >= 0x4400 && address <= 0x47FF) {
-        // UART TX
-        return running_state.button_state;
+    if (mode_name.empty())
+        mode_name = Explorer::ForkSupported() ? "fork" : "snapshot";
+
+    if (mode_name != "fork" && mode_name != "snapshot") {
+        std::cerr << "Unknown explore mode " << mode_name << "\n";
+        return -1;
     }
 
-    if (address >= 0x4800 && address <= 0x4BFF) {
-        // UART RX
-        return 0x00;
+    Explorer explorer(std::max(argparser.get<int>("jobs"), 0));
+
+    if (!explorer.run(gamate, sequences, mode_name == "fork" ? Explorer::Fork : Explorer::Snapshot)) {
+        std::cerr << "Could not explore every sequence\n";
+        return -1;
     }
 
-    if (address >= 0x4C00 && address <= 0x4FFF) {
-        // TX shift register?
-        return 0xFF;
+    // the same state reached by different inputs only needs exploring once
+    StateTable distinct(sequences.size());
+    uint64_t frames = 0;
+
+    const auto &results = explorer.resultList();
+
+    for (size_t i = 0; i < results.size(); i++) {
+        const auto &result = results[i];
+        bool first = distinct.insert(result.hash, i);
+
+        std::cout << i << " " << std::hex << std::setw(16) << std::setfill('0') << result.hash << " RAM CRC " << std::setw(8) << Movie::CRC(result.RAM.data(), result.RAM.size()) << std::dec;
+
+        if (!first)
+            std::cout << " same as " << *distinct.find(result.hash);
+
+        std::cout << "\n";
+        frames += result.frames;
     }
 
-    if (address >= 0x5000 && address <= 0x53FF) {
-        // LCD (8) registers
-        return lcd.read(address);
+    std::cout << sequences.size() << " sequences (" << distinct.size() << " distinct end states) with " << mode_name << " on " << explorer.workers() << " workers in " << explorer.seconds() << "s ("
+        << (sequences.size() / explorer.seconds()) << " sequences/s, " << (frames / explorer.seconds()) << " fps)\n";
+
+    return 0;
+}
+
+static int run_headless(Emulator &emulator, Movie &movie, cmdline::parser &argparser) {
+    std::string video_path = argparser.get<std::string>("video");
+
+    if (!emulator.ready()) {
+        std::cerr << "Headless mode needs a ROM and BIOS\n";
+        return -1;
     }
 
-    if (address >= 0x5400 && address <= 0x57FF) {
-        // reads external space, which is usually 0xFF
-        return 0xFF;
+    // exploring can branch straight from power on
+    if (!movie.frameCount() && !argparser.get<std::string>("explore").length()) {
+        std::cerr << "Headless mode needs a movie to play (--movie)\n";
+        return -1;
     }
 
-    if (address >= 0x5800 && address <= 0x58FF) {
-        //reads open bus
-        return 0xFF;
+    if (movie.frameCount() && (movie.romCRC() != gamate.romImage()->crc() || movie.biosCRC() != gamate.biosImage()->crc())) {
+        std::cerr << "Movie was recorded with a different ROM or BIOS\n";
+        return -1;
     }
 
-    if (address >= 0x5900 && address <= 0x59FF) {
-        // Write address?
-        return 0xFF;
+    gamate.running_state.paused = false;
+    gamate.reset();
+
+    movie.startPlayback();
+
+    if (video_path.length()) {
+        capture.startVideo(video_path, emulator.scale);
     }
 
-    if (address >= 0x5A00 && address <= 0x5AFF) {
-        //always returns 11b in bits 1:0, the other 6 bits are open bus (i.e. reads 5Bh)
-        return 0x5B;
+    uint32_t frames = 0;
+    auto start = std::chrono::steady_clock::now();
+
+    while (movie.next(gamate.running_state.button_state)) {
+        // nobody to hand control to, so breaks are logged and the frame carries on
+        while (!gamate.runFrame())
+            std::cerr << Debugger::FormatStop(debugger.lastStop()) << "\n";
+
+        capture.videoFrame(gamate.lcd, emulator.palette);
+        frames++;
     }
 
-    if (address >= 0x5B00 && address <= 0x5FFF) {
-        // Open bus
-        return 0x5B;
+    capture.stopVideo();
+    capture.flush();
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    std::array<uint32_t, LCD::ScreenWidth*LCD::ScreenHeight> screen;
+    gamate.lcd.update(emulator.palette, screen);
+
+    std::cout << frames << " frames in " << elapsed.count() << "s (" << (frames / elapsed.count()) << " fps)\n";
+    std::cout << "RAM CRC " << std::hex << std::setw(8) << std::setfill('0') << Movie::CRC(gamate.running_state.RAM.data(), gamate.running_state.RAM.size())
+        << " screen CRC " << std::setw(8) << Movie::CRC(reinterpret_cast<const uint8_t*>(screen.data()), sizeof(screen)) << std::dec << "\n";
+
+    // the end of the movie is the branch point
+    if (argparser.get<std::string>("explore").length())
+        return run_explore(argparser);
+
+    return 0;
+}
+
+static void stop_server(int) {
+    server_stopping = 1;
+}
+
+static int run_server(Emulator &emulator, cmdline::parser &argparser) {
+    std::string name = argparser.get<std::string>("serve");
+
+    if (!emulator.ready()) {
+        std::cerr << "Headless mode needs a ROM and BIOS\n";
+        return -1;
     }
 
-    /*
-        Split ROM address space into 2 16KiB banks
-    */
-    if (address >= 0x6000 && address <= 0x9FFF) {
-        // ROM (cartridge) data (bank 0)
-        if (running_state.protection_check) {
-            uint8_t check = 0;
+    if (!frame_server.open(name))
+        return -1;
 
-            check = ((0x47 >> --running_state.protection_check) & 0x01) << 1;
+    // the shared memory is only unlinked on the way out through close()
+    std::signal(SIGINT, stop_server);
+    std::signal(SIGTERM, stop_server);
 
-            return check;
+    gamate.running_state.paused = false;
+    gamate.reset();
+
+    std::cerr << "Serving frames at " << name << "\n";
+
+    auto start = std::chrono::steady_clock::now();
+
+    while (!server_stopping && !frame_server.quitRequested()) {
+        // a lockstep client holds each frame until it has read the last
+        if (frame_server.lockstep() && !frame_server.caughtUp()) {
+            std::this_thread::yield();
+            continue;
         }
 
-        return ROM[running_state.bank0_offset + (address - 0x6000)];
-    }
+        gamate.running_state.button_state = 0xFF;
+        frame_server.applyInput(gamate.running_state.button_state);
 
-    if (address >= 0xA000 && address <= 0xDFFF) {
-        // ROM (cartridge) data (bank 1)
-        return ROM[running_state.bank1_offset + (address - 0xA000)];
-    }
+        while (!gamate.runFrame())
+            std::cerr << Debugger::FormatStop(debugger.lastStop()) << "\n";
 
-    if (address >= 0xE000 && address <= 0xFFFF) {
-        // BIOS (4k repeated twice)
-        return BIOS[address & 0x0FFF];
+        frame_server.publish(gamate);
     }
 
-    std::cerr << "ADDRESS " << std::hex << address << " NOT HANDLED\n";
-    exit(-1);
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    std::cout << frame_server.frameCount() << " frames served in " << elapsed.count() << "s (" << (frame_server.frameCount() / elapsed.count()) << " fps)\n";
 
-    return 0x00;
+    frame_server.close();
+
+    return 0;
 }
 
-void write6502(uint16_t address, uint8_t value) {
-    if (address >= 0x0000 && address <= 0x1FFF) {
-        running_state.RAM[address & 0x03FF] = value;
-        return;
+static int run_regression(cmdline::parser &argparser, std::shared_ptr<const SharedImage> bios) {
+    if (!bios) {
+        std::cerr << "Regression mode needs a BIOS\n";
+        return -1;
     }
 
-    if (address >= 0x2000 && address <= 0x3FFF) {
-        // peripheral space
-        return;
-    }
+    std::string directory = argparser.get<std::string>("regress");
+    std::string golden_path = argparser.get<std::string>("golden");
 
-    if (address >= 0x4000 && address <= 0x43FF) {
-        // Audio
-        PSG_writeReg(&psg, address & 0x0F, value);
-        return;
-    }
+    if (golden_path.empty())
+        golden_path = (std::filesystem::path(directory) / "golden.txt").string();
 
-    if (address >= 0x4400 && address <= 0x47FF) {
-        // UART TX
-        return;
+    std::vector<int32_t> frames = Regression::ParseFrames(argparser.get<std::string>("frames"));
+    if (frames.empty()) {
+        std::cerr << "No frames to check\n";
+        return -1;
     }
 
-    if (address >= 0x4800 && address <= 0x4BFF) {
-        // UART RX
-        return;
-    }
+    bool update = argparser.exist("update-golden");
 
-    if (address >= 0x4C00 && address <= 0x4FFF) {
-        // TX shift register?
-        return;
-    }
+    Regression regression(bios, frames);
 
-    if (address >= 0x5000 && address <= 0x53FF) {
-        // LCD (8) registers
-        
-        lcd.write(address, value);
-        return;
+    if (!update && !regression.loadGolden(golden_path)) {
+        std::cerr << "Could not open golden file " << golden_path << "\n";
+        return -1;
     }
 
-    if (address >= 0x5400 && address <= 0x57FF) {
-        // reads external space, which is usually 0xFF
-        return;
-    }
+    size_t jobs = argparser.get<int>("jobs") > 0 ? argparser.get<int>("jobs") : std::thread::hardware_concurrency();
 
-    if (address >= 0x5800 && address <= 0x58FF) {
-        //reads open bus
-        return;
-    }
+    auto start = std::chrono::steady_clock::now();
+    regression.run(directory, jobs);
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
 
-    if (address >= 0x5900 && address <= 0x59FF) {
-        // Write address?
-        return;
-    }
+    int32_t failures = regression.report(std::cout, update);
+    std::cout << "Finished in " << elapsed.count() << "s\n";
 
-    if (address >= 0x5A00 && address <= 0x5AFF) {
-        //always returns 11b in bits 1:0, the other 6 bits are open bus (i.e. reads 5Bh)
-        return;
+    if (update && !regression.saveGolden(golden_path)) {
+        std::cerr << "Could not write golden file " << golden_path << "\n";
+        return -1;
     }
 
-    if (address >= 0x5B00 && address <= 0x5FFF) {
-        // Open bus
-        return;
+    return failures ? 1 : 0;
+}
+
+static void save_trace(const std::string &trace_path) {
+    if (trace_path.length() && !Trace::Save(trace_path)) {
+        std::cerr << "Could not write trace file " << trace_path << "\n";
     }
+}
 
-    if (address >= 0x6000 && address <= 0xDFFF) {
-        // ROM (cartridge) data
-        if (address == 0xC000) {
-            // Standard bank switcher
-            running_state.bank1_offset = 0x4000 * value;
-        }
+static void save_profile(const std::string &profile_path) {
+    if (profile_path.length()) {
+        profiler.disable();
+        profiler.save(profile_path, 1000);
+    }
+}
 
-        if (address == 0x8000) {
-            // 4 in 1 Regular bank switcher
-            running_state.bank0_offset = 0x4000 * value;
-        }
-        return;
+static void save_instruction_trace(const std::string &itrace_path) {
+    if (itrace_path.length() && !instruction_trace->save(itrace_path)) {
+        std::cerr << "Could not write instruction trace " << itrace_path << "\n";
     }
+}
 
-    if (address >= 0xE000 && address <= 0xFFFF) {
-        // BIOS (4k repeated twice)
-        BIOS[address & 0x0FFF] = value;
-        return;
+static void AudioInputCallback(void *buffer, unsigned int frames) {
+    static thread_local bool named = false;
+    if (!named) {
+        Trace::NameThread("Audio");
+        named = true;
     }
 
-    std::cerr << "ADDRESS " << std::hex << address << " NOT HANDLED\n";
-    exit(-1);
+    Trace::Zone zone("Audio callback");
 
-}
+    pacer.audioConsumed(frames);
 
-static void AudioInputCallback(void *buffer, unsigned int frames) {
-    if (running_state.audio_enabled) {
-        PSG_calc_stereo(&psg, (int16_t *)buffer, frames * 2);
+    const RunningState &running_state = gamate.running_state;
+
+    if (running_state.audio_enabled && !running_state.fast_forward && !running_state.background) {
+        PSG_calc_stereo(&gamate.psg, (int16_t *)buffer, frames * 2);
     } else {
         std::memset(buffer, 0, sizeof(int16_t) * frames * 2);
     }
@@ -253,8 +348,35 @@ int main(int argc, char *argv[]) {
     argparser.add<std::string>("bios", 'b', "BIOS", false, "gamate.zip");
     argparser.add<int>("scale", 's', "Screen scale", false, 4);
     argparser.add<int>("colour", 'c', "Colour", false, 0);
+    argparser.add<int>("runahead", 'a', "Frames to run ahead (0-2)", false, 0, cmdline::range(0, 2));
+    argparser.add<int>("rewind", 'w', "Rewind buffer size in MiB (0 to disable)", false, 8);
+    argparser.add<std::string>("library", 'l', "ROM library directory to index", false, "");
+    argparser.add<std::string>("romdb", '\0', "ROM database", false, "assets/gamate.dat");
+    argparser.add<std::string>("movie", 'm', "Input movie to play back", false, "");
+    argparser.add<std::string>("video", '\0', "Record video (Y4M) to a file from the start", false, "");
+    argparser.add<std::string>("trace", '\0', "Write a Chrome trace (JSON) of frame phases to a file on exit", false, "");
+    argparser.add<std::string>("profile", '\0', "Profile the guest from the start and write a hotspot report to a file on exit", false, "");
+    argparser.add<std::string>("itrace", '\0', "Trace executed instructions and write the most recent to a file on exit or crash", false, "");
+    argparser.add<int>("itrace-size", '\0', "Instruction trace ring size in instructions", false, 1 << 20, cmdline::range(1, 1 << 26));
+    argparser.add<std::string>("break", '\0', "Comma separated breakpoint addresses (hex) to stop at", false, "");
+    argparser.add("headless", '\0', "Play the movie without a window at uncapped speed");
+    argparser.add<std::string>("regress", '\0', "Check every ROM in a directory against its golden screen CRCs", false, "");
+    argparser.add<std::string>("golden", '\0', "Golden file (default golden.txt in the regression directory)", false, "");
+    argparser.add<std::string>("frames", '\0', "Comma separated frames to check", false, "60,300,600");
+    argparser.add<std::string>("explore", '\0', "Headless: run each input sequence in a file from the end of the movie and report where they end up", false, "");
+    argparser.add<std::string>("explore-mode", '\0', "fork (a copy on write child per sequence) or snapshot (restore a saved state per sequence)", false, "");
+    argparser.add<std::string>("serve", '\0', "Publish frames to and take buttons from shared memory of this name, e.g. /megata (runs until stopped with --headless)", false, "");
+    argparser.add<int>("jobs", 'j', "Worker threads or processes for --regress and --explore (0 for one per core)", false, 0);
+    argparser.add("update-golden", '\0', "Write the golden file instead of checking it");
     argparser.parse_check(argc, argv);
 
+    std::string trace_path = argparser.get<std::string>("trace");
+
+    if (trace_path.length()) {
+        Trace::Enable(true);
+        Trace::NameThread("Main");
+    }
+
     Emulator emulator;
 
     NFD::Init();
@@ -262,25 +384,124 @@ int main(int argc, char *argv[]) {
     emulator.rom = argparser.get<std::string>("rom");
     emulator.bios = argparser.get<std::string>("bios");
     emulator.scale = argparser.get<int>("scale");
+    emulator.run_ahead = argparser.get<int>("runahead");
 
-    SetConfigFlags(FLAG_MSAA_4X_HINT|FLAG_WINDOW_RESIZABLE);
-    raylib::Window window(1280, 960, "Megata" + std::string(" (v") + std::string(VERSION) + ")");
-    SetTargetFPS(68);
+    Rewind rewind((size_t)std::max(argparser.get<int>("rewind"), 0) * 1024 * 1024);
+    Movie movie;
+
+    if (argparser.get<std::string>("movie").length()) {
+        if (!movie.load(argparser.get<std::string>("movie"))) {
+            std::cerr << "Could not open movie file " << argparser.get<std::string>("movie") << "\n";
+            exit(-1);
+        }
+    }
 
     if (emulator.rom.length()) {
-        if (!load_file(emulator.rom, ROM.data(), ROM.size())) {
+        auto image = SharedImage::Load(emulator.rom, Gamate::MaxROMSize);
+
+        if (image) {
+            gamate.setROM(image);
+        } else {
             std::cerr << "Could not open ROM file " << emulator.rom << "\n";
             emulator.rom = "";
         }
     }
 
     if (emulator.bios.length()) {
-        if (!load_file(emulator.bios, BIOS.data(), BIOS.size())) {
+        auto image = SharedImage::Load(emulator.bios, Gamate::BIOSSize);
+
+        if (image) {
+            gamate.setBIOS(image);
+        } else {
             std::cerr << "Could not open BIOS file " << emulator.bios << "\n";
             emulator.bios = "";
         }
     }
 
+    RunningState &running_state = gamate.running_state;
+
+    switch (argparser.get<int>("colour")) {
+        case 1:
+            emulator.palette = grey_palette;
+            break;
+        case 2:
+            emulator.palette = gb_palette;
+            break;
+        case 3:
+            emulator.palette = gbp_palette;
+            break;
+        default:
+            emulator.palette = green_palette;
+    }
+
+    if (argparser.get<std::string>("regress").length()) {
+        int status = run_regression(argparser, gamate.biosImage());
+        save_trace(trace_path);
+        NFD::Quit();
+        exit(status);
+    }
+
+    std::string profile_path = argparser.get<std::string>("profile");
+
+    if (profile_path.length()) {
+        profiler.enable(gamate);
+    }
+
+    std::string itrace_path = argparser.get<std::string>("itrace");
+
+    instruction_trace = std::make_unique<InstructionTrace>(argparser.get<int>("itrace-size"));
+
+    if (itrace_path.length()) {
+        instruction_trace->enable(gamate);
+        instruction_trace->dumpOnCrash(itrace_path);
+    }
+
+    if (argparser.get<std::string>("break").length()) {
+        std::stringstream addresses(argparser.get<std::string>("break"));
+        std::string address;
+
+        debugger.attach(gamate);
+
+        while (std::getline(addresses, address, ',')) {
+            uint16_t breakpoint;
+
+            if (!Debugger::ParseAddress(address, breakpoint)) {
+                std::cerr << "Invalid breakpoint address " << address << "\n";
+                exit(-1);
+            }
+
+            debugger.addBreakpoint(breakpoint);
+        }
+    }
+
+    if (argparser.exist("headless")) {
+        int status = argparser.get<std::string>("serve").length() ? run_server(emulator, argparser) : run_headless(emulator, movie, argparser);
+        save_trace(trace_path);
+        save_profile(profile_path);
+        save_instruction_trace(itrace_path);
+        NFD::Quit();
+        exit(status);
+    }
+
+    if (!library.loadDatabase(argparser.get<std::string>("romdb")) && argparser.exist("romdb")) {
+        std::cerr << "Could not open ROM database " << argparser.get<std::string>("romdb") << "\n";
+    }
+
+    // show the saved index straight away, the rescan only rehashes changed files
+    library.loadIndex();
+
+    if (argparser.get<std::string>("library").length()) {
+        std::error_code ec;
+        std::filesystem::path directory = std::filesystem::weakly_canonical(argparser.get<std::string>("library"), ec);
+
+        library.setDirectory(ec ? argparser.get<std::string>("library") : directory.string());
+    }
+
+    library.scan();
+
+    SetConfigFlags(FLAG_MSAA_4X_HINT|FLAG_WINDOW_RESIZABLE);
+    raylib::Window window(1280, 960, "Megata" + std::string(" (v") + std::string(VERSION) + ")");
+
     running_state.paused = !emulator.ready();
 
     std::array<uint32_t, LCD::ScreenWidth*LCD::ScreenHeight> screen = {0xFF};
@@ -290,12 +511,6 @@ int main(int argc, char *argv[]) {
 
     int gamepad = 0;
 
-    PSG_init(&psg, 4433000/4, 44100);
-    PSG_setVolumeMode(&psg, 2);
-    PSG_set_quality(&psg, true);
-    PSG_setFlags(&psg, EMU2149_ZX_STEREO);
-    PSG_reset(&psg);
-
     std::unique_ptr<raylib::AudioDevice> audio_device = nullptr;
     std::unique_ptr<raylib::AudioStream> audio_stream = nullptr;
 
@@ -313,30 +528,47 @@ int main(int argc, char *argv[]) {
         running_state.audio_enabled = false;
     }
 
-    switch (argparser.get<int>("colour")) {
-        case 1:
-            emulator.palette = grey_palette;
-            break;
-        case 2:
-            emulator.palette = gb_palette;
-            break;
-        case 3:
-            emulator.palette = gbp_palette;
-            break;
-        default:
-            emulator.palette = green_palette;
-    }
-
     rlImGuiSetup(true);
 
     auto &imgui_io = ImGui::GetIO();
     imgui_io.IniFilename = nullptr;
 
-    CPU cpu(read6502, write6502, [](){return INT::QUIT;});
-    cpu.reset();
-    cpu.setPeriod(32768);
+    gamate.reset();
+
+    if (movie.frameCount() && emulator.ready()) {
+        if (movie.romCRC() != gamate.romImage()->crc() || movie.biosCRC() != gamate.biosImage()->crc()) {
+            std::cerr << "Movie was recorded with a different ROM or BIOS, not playing it\n";
+        } else {
+            movie.startPlayback();
+        }
+    }
+
+    if (argparser.get<std::string>("serve").length()) {
+        frame_server.open(argparser.get<std::string>("serve"));
+    }
+
+    if (argparser.get<std::string>("video").length()) {
+        capture.startVideo(argparser.get<std::string>("video"), emulator.scale);
+    }
+
+    uint32_t speed_frames = 0;
+    auto speed_start = std::chrono::steady_clock::now();
+
+    bool event_waiting = false;
+    Palette shown_palette = {};
+
+    pacer.resync();
 
     while (!window.ShouldClose()) {
+        // frames are paced from the audio clock, fast forward runs unpaced and idle frames wait on window events
+        Trace::Zone wait_zone("Pacer wait");
+        int32_t frames_due = (running_state.fast_forward || event_waiting) ? 1 : pacer.wait();
+        int32_t display_frames = 0;
+        wait_zone.end();
+
+        perf.mark(Perf::Wait);
+
+        Trace::Zone input_zone("Input");
         running_state.button_state = 0xFF;
         if (IsKeyDown(keyboard_input.up)) {
             running_state.button_state ^= 0b00000001;
@@ -413,19 +645,134 @@ int main(int argc, char *argv[]) {
 
         }
 
-        if (!running_state.paused) {
-            cpu.run();
-            cpu.interupt(INT::IRQ);
-            cpu.setPeriod(32768);
-            cpu.run();
-            cpu.interupt(INT::IRQ);
-            cpu.setPeriod(7364);
-            cpu.run();
-            cpu.setPeriod(32768 - 7364);
+        // a client driving the buttons over shared memory takes over from the keyboard and gamepad
+        frame_server.applyInput(running_state.button_state);
+
+        input_zone.end();
+
+        running_state.background = IsWindowMinimized() || (emulator.pause_unfocused && !IsWindowFocused());
+
+        bool halted = running_state.paused || running_state.background;
+        bool rewinding = rewind.enabled() && !movie.active() && IsKeyDown(keyboard_input.rewind);
+
+        running_state.fast_forward = !halted && !rewinding && (emulator.fast_forward || IsKeyDown(keyboard_input.fast_forward));
+
+        if (!halted) {
+            if (rewinding) {
+                Trace::Zone zone("Rewind");
+
+                if (rewind.pop(rewind_state)) {
+                    rewind_state.restore(gamate);
+                    capture.videoFrame(gamate.lcd, emulator.palette);
+                }
+            } else {
+                // when fast forwarding keep emulating until most of the display frame is used, only the last frame is drawn
+                auto deadline = std::chrono::steady_clock::now() + FastForwardBudget;
+                uint8_t live_button_state = running_state.button_state;
+                int32_t frames_emulated = 0;
+
+                do {
+                    Trace::Zone zone("Frame");
+
+                    // a frame left by a debugger break already has its input and rewind state
+                    if (!gamate.midFrame()) {
+                        if (movie.playing()) {
+                            if (!movie.next(running_state.button_state)) {
+                                running_state.button_state = live_button_state;
+                            }
+                        } else if (movie.recording()) {
+                            movie.record(running_state.button_state);
+                        }
+
+                        if (rewind.enabled()) {
+                            rewind_state.capture(gamate);
+                            rewind.push(rewind_state);
+                        }
+                    }
+
+                    if (!gamate.runFrame()) {
+                        // stay put until unpaused, the frame then carries on from the break
+                        std::cerr << Debugger::FormatStop(debugger.lastStop()) << "\n";
+                        running_state.paused = true;
+                        running_state.audio_enabled = false;
+                        halted = true;
+                        break;
+                    }
+
+                    if (cheat_search.enabled()) {
+                        cheat_search.capture(gamate);
+                    }
+
+                    capture.videoFrame(gamate.lcd, emulator.palette);
+                    frame_server.publish(gamate);
+                    speed_frames++;
+                    display_frames++;
+                } while (++frames_emulated < frames_due || (running_state.fast_forward && std::chrono::steady_clock::now() < deadline));
+            }
         }
 
-        lcd.update(emulator.palette, screen);
-        screen_texture.Update(screen.data());
+        if (halted || running_state.fast_forward) {
+            pacer.resync();
+        }
+
+        if (halted != event_waiting) {
+            if (halted) {
+                EnableEventWaiting();
+            } else {
+                DisableEventWaiting();
+            }
+
+            event_waiting = halted;
+        }
+
+        std::chrono::duration<double> speed_elapsed = std::chrono::steady_clock::now() - speed_start;
+        if (speed_elapsed.count() >= 0.5) {
+            running_state.speed = speed_frames * FrameCycles / (speed_elapsed.count() * CPUClock);
+            speed_frames = 0;
+            speed_start = std::chrono::steady_clock::now();
+        }
+
+        // only redraw the screen when the LCD or palette could have changed it
+        bool redraw = gamate.lcd.hasChanged() || shown_palette != emulator.palette;
+
+        if (!halted && !rewinding && !running_state.fast_forward && emulator.run_ahead > 0 && !debugger.attached()) {
+            // show a frame from the future with the current input, then roll back
+            Trace::Zone zone("Run ahead");
+            run_ahead_state.capture(gamate);
+            running_state.run_ahead = true;
+
+            // speculative frames are rolled back, so they don't count towards emulated fps or MIPS
+            uint64_t instructions = gamate.cpu.instructionCount();
+            uint64_t cycles = gamate.cpu.cycleCount();
+
+            for (int32_t frame = 0; frame < emulator.run_ahead; frame++) {
+                gamate.runFrame();
+            }
+
+            perf.mark(Perf::Emulate);
+            Trace::Zone lcd_zone("LCD update");
+            gamate.lcd.update(emulator.palette, screen);
+            lcd_zone.end();
+
+            run_ahead_state.restoreMachine(gamate);
+            gamate.cpu.restoreCounts(instructions, cycles);
+            running_state.run_ahead = false;
+            redraw = true;
+        } else if (redraw) {
+            perf.mark(Perf::Emulate);
+            Trace::Zone zone("LCD update");
+            gamate.lcd.update(emulator.palette, screen);
+        }
+
+        perf.mark(redraw ? Perf::LCDUpdate : Perf::Emulate);
+
+        if (redraw) {
+            Trace::Zone zone("Texture update");
+            screen_texture.Update(screen.data());
+            shown_palette = emulator.palette;
+        }
+
+        perf.mark(Perf::TextureUpload);
 
         BeginDrawing();
         {
@@ -437,14 +784,28 @@ int main(int argc, char *argv[]) {
             window.ClearBackground(BLACK);
             screen_texture.Draw(raylib::Rectangle(Vector2(LCD::ScreenWidth, LCD::ScreenHeight)), raylib::Rectangle(Vector2(LCD::ScreenWidth*emulator.scale, LCD::ScreenHeight*emulator.scale)), lcd_origin);
 
-            if (UI::Draw(running_state, lcd, cpu, emulator, keyboard_input, gamepad_input)) {
+            Trace::Zone ui_zone("UI::Draw");
+            if (UI::Draw(gamate, rewind, movie, library, capture, perf, profiler, *instruction_trace, debug_view, cheat_view, emulator, keyboard_input, gamepad_input)) {
                 break;
             }
+            ui_zone.end();
+
+            perf.mark(Perf::UI);
         }
+        Trace::Zone present_zone("EndDrawing");
         EndDrawing();
+        present_zone.end();
+
+        perf.mark(Perf::Present);
+        perf.setAudio(running_state.audio_enabled ? pacer.audioRequest() : 0, pacer.lead());
+        perf.endFrame(gamate.cpu.instructionCount(), gamate.cpu.cycleCount(), display_frames);
     }
     rlImGuiShutdown();
 
+    save_trace(trace_path);
+    save_profile(profile_path);
+    save_instruction_trace(itrace_path);
+
     NFD::Quit();
     exit (0);
 }
@@ -0,0 +1,300 @@
+/******************************************************************************
+
+Copyright (C) 2025 Neil Richardson (nrich@neiltopia.com)
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, version 3.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+
+******************************************************************************/
+
+
+#include <array>
+#include <memory>
+#include <new>
+#include <vector>
+
+#include "Emulation.h"
+#include "Gamate.h"
+#include "LCD.h"
+#include "SaveState.h"
+#include "SharedImage.h"
+#include "StateHash.h"
+#include "VectorEnv.h"
+#include "megata.h"
+
+static_assert(MEGATA_SCREEN_WIDTH == LCD::ScreenWidth && MEGATA_SCREEN_HEIGHT == LCD::ScreenHeight, "screen size mismatch");
+static_assert(MEGATA_RAM_SIZE == sizeof(RunningState::RAM), "RAM size mismatch");
+
+// the frontend's default green palette as 0xAABBGGRR
+static const Palette DefaultPalette = {0xFF4AA66B, 0xFF637A43, 0xFF555925, 0xFF4C4212};
+
+struct megata {
+    Gamate gamate;
+    StateHash state_hash;
+
+    // set once megata_ram() has handed out the pointer, writes through it can come at any time
+    bool ram_shared = false;
+    uint32_t sample_rate;
+
+    uint64_t frames = 0;
+
+    Palette palette = DefaultPalette;
+    std::array<uint32_t, LCD::ScreenWidth*LCD::ScreenHeight> screen;
+    std::array<uint8_t, LCD::ScreenWidth*LCD::ScreenHeight> shades;
+    bool screen_stale = true;
+    bool shades_stale = true;
+
+    std::vector<int16_t> audio;
+    uint64_t audio_remainder = 0;
+
+    megata(uint32_t sample_rate) : gamate(sample_rate ? sample_rate : 44100), state_hash(gamate), sample_rate(sample_rate) {
+        screen.fill(palette[0]);
+        shades.fill(0);
+    }
+
+    void stepped() {
+        screen_stale = true;
+        shades_stale = true;
+    }
+};
+
+struct megata_vec {
+    VectorEnv env;
+
+    megata_vec(size_t count, std::shared_ptr<const SharedImage> rom, std::shared_ptr<const SharedImage> bios, size_t threads) : env(count, rom, bios, threads) {
+    }
+};
+
+int megata_api_version(void) {
+    return MEGATA_API_VERSION;
+}
+
+megata_t *megata_create(uint32_t sample_rate) {
+    return new (std::nothrow) megata(sample_rate);
+}
+
+void megata_destroy(megata_t *megata) {
+    delete megata;
+}
+
+int megata_load_rom(megata_t *megata, const uint8_t *data, size_t size) {
+    if (!megata || !data || !size || size > Gamate::MaxROMSize)
+        return MEGATA_ERROR_ARGUMENT;
+
+    megata->gamate.setROM(SharedImage::FromMemory(data, size));
+    megata_reset(megata);
+
+    return MEGATA_OK;
+}
+
+int megata_load_bios(megata_t *megata, const uint8_t *data, size_t size) {
+    if (!megata || !data || !size || size > Gamate::BIOSSize)
+        return MEGATA_ERROR_ARGUMENT;
+
+    megata->gamate.setBIOS(SharedImage::FromMemory(data, size));
+    megata_reset(megata);
+
+    return MEGATA_OK;
+}
+
+void megata_reset(megata_t *megata) {
+    megata->gamate.running_state.paused = false;
+    megata->gamate.reset();
+
+    megata->frames = 0;
+    megata->audio.clear();
+    megata->audio_remainder = 0;
+    megata->stepped();
+}
+
+void megata_set_buttons(megata_t *megata, uint8_t buttons) {
+    // the hardware reads held buttons as 0 bits
+    megata->gamate.running_state.button_state = ~buttons;
+}
+
+int megata_step(megata_t *megata, int frames) {
+    Gamate &gamate = megata->gamate;
+
+    if (!gamate.ready())
+        return MEGATA_ERROR_NOT_READY;
+
+    megata->audio.clear();
+
+    for (int frame = 0; frame < frames; frame++) {
+        gamate.runFrame();
+        megata->frames++;
+
+        if (megata->sample_rate) {
+            // whole samples due this frame, the fraction carries over
+            megata->audio_remainder += (uint64_t)megata->sample_rate * FrameCycles;
+            size_t count = megata->audio_remainder / CPUClock;
+            megata->audio_remainder %= CPUClock;
+
+            size_t used = megata->audio.size();
+            megata->audio.resize(used + count * 2);
+            PSG_calc_stereo(&gamate.psg, megata->audio.data() + used, count * 2);
+        }
+    }
+
+    if (frames > 0)
+        megata->stepped();
+
+    return frames > 0 ? frames : 0;
+}
+
+uint64_t megata_frame_count(const megata_t *megata) {
+    return megata->frames;
+}
+
+void megata_set_palette(megata_t *megata, const uint32_t palette[4]) {
+    for (int i = 0; i < 4; i++)
+        megata->palette[i] = palette[i];
+
+    megata->screen_stale = true;
+}
+
+const uint32_t *megata_framebuffer(megata_t *megata) {
+    if (megata->screen_stale) {
+        megata->gamate.lcd.update(megata->palette, megata->screen);
+        megata->screen_stale = false;
+    }
+
+    return megata->screen.data();
+}
+
+const uint8_t *megata_shades(megata_t *megata) {
+    if (megata->shades_stale) {
+        megata->gamate.lcd.render(megata->shades);
+        megata->shades_stale = false;
+    }
+
+    return megata->shades.data();
+}
+
+uint8_t *megata_ram(megata_t *megata) {
+    megata->ram_shared = true;
+
+    return megata->gamate.running_state.RAM.data();
+}
+
+size_t megata_audio(const megata_t *megata, const int16_t **samples) {
+    if (samples)
+        *samples = megata->audio.data();
+
+    return megata->audio.size() / 2;
+}
+
+size_t megata_state_size(void) {
+    return SaveState::SerializedSize();
+}
+
+int megata_save_state(const megata_t *megata, void *buffer, size_t size) {
+    if (!buffer || size < SaveState::SerializedSize())
+        return MEGATA_ERROR_ARGUMENT;
+
+    SaveState state;
+    state.capture(megata->gamate);
+
+    return state.save((uint8_t *)buffer, size) ? MEGATA_OK : MEGATA_ERROR_STATE;
+}
+
+uint64_t megata_state_hash(megata_t *megata) {
+    // the dirty chunks can't see writes through the megata_ram() pointer, so rehash all of RAM
+    if (megata->ram_shared)
+        megata->gamate.touchRAM();
+
+    return megata->state_hash.hash();
+}
+
+int megata_load_state(megata_t *megata, const void *buffer, size_t size) {
+    if (!buffer)
+        return MEGATA_ERROR_ARGUMENT;
+
+    SaveState state;
+
+    if (!state.load((const uint8_t *)buffer, size))
+        return MEGATA_ERROR_STATE;
+
+    state.restore(megata->gamate);
+    megata->stepped();
+
+    return MEGATA_OK;
+}
+
+megata_vec_t *megata_vec_create(int count, int threads, const uint8_t *rom, size_t rom_size, const uint8_t *bios, size_t bios_size) {
+    if (count <= 0 || threads < 0 || !rom || !rom_size || rom_size > Gamate::MaxROMSize || !bios || !bios_size || bios_size > Gamate::BIOSSize)
+        return nullptr;
+
+    return new (std::nothrow) megata_vec(count, SharedImage::FromMemory(rom, rom_size), SharedImage::FromMemory(bios, bios_size), threads);
+}
+
+void megata_vec_destroy(megata_vec_t *vec) {
+    delete vec;
+}
+
+int megata_vec_configure(megata_vec_t *vec, int frame_skip, int max_pool, int observation, uint32_t max_episode_frames) {
+    if (frame_skip < 1 || (observation != MEGATA_OBSERVATION_SHADES && observation != MEGATA_OBSERVATION_GREYSCALE))
+        return MEGATA_ERROR_ARGUMENT;
+
+    VectorEnv::Options options = {frame_skip, max_pool != 0, observation == MEGATA_OBSERVATION_GREYSCALE ? VectorEnv::Greyscale : VectorEnv::Shades, max_episode_frames};
+    vec->env.setOptions(options);
+
+    return MEGATA_OK;
+}
+
+int megata_vec_set_start_state(megata_vec_t *vec, const void *buffer, size_t size) {
+    if (!buffer) {
+        vec->env.clearStartState();
+        return MEGATA_OK;
+    }
+
+    SaveState state;
+
+    if (!state.load((const uint8_t *)buffer, size))
+        return MEGATA_ERROR_STATE;
+
+    vec->env.setStartState(state);
+
+    return MEGATA_OK;
+}
+
+int megata_vec_step(megata_vec_t *vec, const uint8_t *buttons) {
+    if (!buttons)
+        return MEGATA_ERROR_ARGUMENT;
+
+    vec->env.step(buttons);
+
+    return MEGATA_OK;
+}
+
+void megata_vec_reset(megata_vec_t *vec, int index) {
+    if (index < 0) {
+        vec->env.reset();
+    } else if ((size_t)index < vec->env.size()) {
+        vec->env.reset(index);
+    }
+}
+
+const uint8_t *megata_vec_observations(const megata_vec_t *vec) {
+    return vec->env.observations();
+}
+
+const uint8_t *megata_vec_dones(const megata_vec_t *vec) {
+    return vec->env.dones();
+}
+
+uint8_t *megata_vec_ram(megata_vec_t *vec, int index) {
+    if (index < 0 || (size_t)index >= vec->env.size())
+        return nullptr;
+
+    return vec->env.instance(index).running_state.RAM.data();
+}
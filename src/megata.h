@@ -0,0 +1,155 @@
+/******************************************************************************
+
+Copyright (C) 2025 Neil Richardson (nrich@neiltopia.com)
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, version 3.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+
+******************************************************************************/
+
+
+#ifndef MEGATA_H
+#define MEGATA_H
+
+/*
+    C API for embedding the emulator core without the frontend. Each
+    megata_t is an independent console, instances can run on different
+    threads but a single instance must not be used from two at once.
+
+    Functions returning int return MEGATA_OK or a negative error. The
+    framebuffer, shade, RAM and audio pointers point into the instance
+    and stay valid until it is destroyed, their contents change with the
+    next megata_step().
+*/
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(_WIN64) || defined(_WIN32)
+    #if defined(MEGATA_BUILD_SHARED)
+        #define MEGATA_API __declspec(dllexport)
+    #elif defined(MEGATA_SHARED)
+        #define MEGATA_API __declspec(dllimport)
+    #else
+        #define MEGATA_API
+    #endif
+#else
+    #define MEGATA_API __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define MEGATA_API_VERSION 1
+
+#define MEGATA_SCREEN_WIDTH 160
+#define MEGATA_SCREEN_HEIGHT 150
+#define MEGATA_RAM_SIZE 1024
+
+#define MEGATA_OK 0
+#define MEGATA_ERROR_ARGUMENT -1
+#define MEGATA_ERROR_NOT_READY -2
+#define MEGATA_ERROR_STATE -3
+
+/* buttons for megata_set_buttons(), set bits are held down */
+#define MEGATA_BUTTON_UP 0x01
+#define MEGATA_BUTTON_DOWN 0x02
+#define MEGATA_BUTTON_LEFT 0x04
+#define MEGATA_BUTTON_RIGHT 0x08
+#define MEGATA_BUTTON_A 0x10
+#define MEGATA_BUTTON_B 0x20
+#define MEGATA_BUTTON_START 0x40
+#define MEGATA_BUTTON_SELECT 0x80
+
+typedef struct megata megata_t;
+typedef struct megata_vec megata_vec_t;
+
+MEGATA_API int megata_api_version(void);
+
+/* sample_rate 0 turns audio generation off */
+MEGATA_API megata_t *megata_create(uint32_t sample_rate);
+MEGATA_API void megata_destroy(megata_t *megata);
+
+/* images are copied, loading either resets the console */
+MEGATA_API int megata_load_rom(megata_t *megata, const uint8_t *data, size_t size);
+MEGATA_API int megata_load_bios(megata_t *megata, const uint8_t *data, size_t size);
+
+MEGATA_API void megata_reset(megata_t *megata);
+
+MEGATA_API void megata_set_buttons(megata_t *megata, uint8_t buttons);
+
+/* returns the number of frames run */
+MEGATA_API int megata_step(megata_t *megata, int frames);
+
+MEGATA_API uint64_t megata_frame_count(const megata_t *megata);
+
+/* colours as 0xAABBGGRR for the four shades, the default is the frontend's green */
+MEGATA_API void megata_set_palette(megata_t *megata, const uint32_t palette[4]);
+
+/*
+    160x150 pixels, rendered when first asked for after a step. The
+    shades (0-3 per pixel) skip the palette lookup.
+*/
+MEGATA_API const uint32_t *megata_framebuffer(megata_t *megata);
+MEGATA_API const uint8_t *megata_shades(megata_t *megata);
+
+/* the live 1KiB of RAM, writes go straight to the console */
+MEGATA_API uint8_t *megata_ram(megata_t *megata);
+
+/* interleaved stereo samples made by the last megata_step(), returns the sample frames */
+MEGATA_API size_t megata_audio(const megata_t *megata, const int16_t **samples);
+
+/*
+    64 bit hash of the machine state for deduplicating search states. It
+    is incremental, only memory written since the last call is rehashed.
+    Once megata_ram() has been called all 1KiB of RAM is rehashed every
+    time, since writes through its pointer can't be tracked.
+*/
+MEGATA_API uint64_t megata_state_hash(megata_t *megata);
+
+MEGATA_API size_t megata_state_size(void);
+MEGATA_API int megata_save_state(const megata_t *megata, void *buffer, size_t size);
+MEGATA_API int megata_load_state(megata_t *megata, const void *buffer, size_t size);
+
+/*
+    A batch of count consoles on the same ROM, stepped together across
+    threads (0 for one per core). Each step takes one button mask per
+    console and leaves a contiguous count x 150 x 160 byte observation
+    array, see VectorEnv.h for the options.
+*/
+#define MEGATA_OBSERVATION_SHADES 0
+#define MEGATA_OBSERVATION_GREYSCALE 1
+
+MEGATA_API megata_vec_t *megata_vec_create(int count, int threads, const uint8_t *rom, size_t rom_size, const uint8_t *bios, size_t bios_size);
+MEGATA_API void megata_vec_destroy(megata_vec_t *vec);
+
+/* max_episode_frames 0 for no limit, consoles reaching it start over and report done */
+MEGATA_API int megata_vec_configure(megata_vec_t *vec, int frame_skip, int max_pool, int observation, uint32_t max_episode_frames);
+
+/* episodes start from a state saved by megata_save_state(), NULL for power on */
+MEGATA_API int megata_vec_set_start_state(megata_vec_t *vec, const void *buffer, size_t size);
+
+MEGATA_API int megata_vec_step(megata_vec_t *vec, const uint8_t *buttons);
+
+/* index -1 resets every console */
+MEGATA_API void megata_vec_reset(megata_vec_t *vec, int index);
+
+MEGATA_API const uint8_t *megata_vec_observations(const megata_vec_t *vec);
+MEGATA_API const uint8_t *megata_vec_dones(const megata_vec_t *vec);
+MEGATA_API uint8_t *megata_vec_ram(megata_vec_t *vec, int index);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //MEGATA_H
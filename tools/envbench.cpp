@@ -0,0 +1,93 @@
+/******************************************************************************
+
+Copyright (C) 2025 Neil Richardson (nrich@neiltopia.com)
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, version 3.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+
+******************************************************************************/
+
+
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <cmdline.h>
+
+#include "Emulation.h"
+#include "SharedImage.h"
+#include "VectorEnv.h"
+
+/*
+    Steps VectorEnv batches of 1, 2, 4 ... environments with random
+    buttons and reports environment steps and emulated frames per second
+    for each batch size.
+*/
+int main(int argc, char *argv[]) {
+    cmdline::parser argparser;
+    argparser.add<std::string>("rom", 'r', "ROM file", true, "");
+    argparser.add<std::string>("bios", 'b', "BIOS file", true, "");
+    argparser.add<int>("max-envs", 'k', "Largest batch", false, 256, cmdline::range(1, 4096));
+    argparser.add<int>("threads", 'j', "Worker threads (0 for one per core)", false, 0);
+    argparser.add<int>("frame-skip", 'f', "Frames per step", false, 4, cmdline::range(1, 64));
+    argparser.add<double>("seconds", 's', "Time per batch size", false, 1.0);
+    argparser.add("max-pool", '\0', "Max pool the last two frames of a step");
+    argparser.add("greyscale", '\0', "Greyscale observations instead of shades");
+    argparser.parse_check(argc, argv);
+
+    auto rom = SharedImage::Load(argparser.get<std::string>("rom"), Gamate::MaxROMSize);
+    auto bios = SharedImage::Load(argparser.get<std::string>("bios"), Gamate::BIOSSize);
+
+    if (!rom || !bios) {
+        std::cerr << "Could not open " << (rom ? "BIOS file " + argparser.get<std::string>("bios") : "ROM file " + argparser.get<std::string>("rom")) << "\n";
+        return -1;
+    }
+
+    VectorEnv::Options options = {argparser.get<int>("frame-skip"), argparser.exist("max-pool"), argparser.exist("greyscale") ? VectorEnv::Greyscale : VectorEnv::Shades, 0};
+    double seconds = argparser.get<double>("seconds");
+    double frame_rate = double(CPUClock) / FrameCycles;
+
+    printf("%6s %8s %12s %12s %10s\n", "envs", "threads", "steps/s", "frames/s", "realtime");
+
+    for (int count = 1; count <= argparser.get<int>("max-envs"); count *= 2) {
+        VectorEnv env(count, rom, bios, argparser.get<int>("threads"));
+        env.setOptions(options);
+
+        std::vector<uint8_t> buttons(count, 0);
+        uint32_t random = 1;
+
+        uint64_t steps = 0;
+        auto start = std::chrono::steady_clock::now();
+        std::chrono::duration<double> elapsed(0);
+
+        while (elapsed.count() < seconds) {
+            for (auto &button : buttons) {
+                random = random * 1664525 + 1013904223;
+                button = random >> 24;
+            }
+
+            env.step(buttons.data());
+            steps += count;
+
+            elapsed = std::chrono::steady_clock::now() - start;
+        }
+
+        double steps_per_second = steps / elapsed.count();
+        double frames_per_second = steps_per_second * options.frame_skip;
+
+        printf("%6d %8zu %12.0f %12.0f %9.0fx\n", count, env.threads(), steps_per_second, frames_per_second, frames_per_second / frame_rate);
+    }
+
+    return 0;
+}
@@ -0,0 +1,111 @@
+/******************************************************************************
+
+Copyright (C) 2025 Neil Richardson (nrich@neiltopia.com)
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, version 3.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+
+******************************************************************************/
+
+
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <cmdline.h>
+
+#include "Explorer.h"
+#include "SharedImage.h"
+
+/*
+    Times Explorer's fork and snapshot modes on the same random input
+    sequences from the same branch point, one worker and then one per
+    core, and checks both modes end in the same states.
+*/
+int main(int argc, char *argv[]) {
+    cmdline::parser argparser;
+    argparser.add<std::string>("rom", 'r', "ROM file", true, "");
+    argparser.add<std::string>("bios", 'b', "BIOS file", true, "");
+    argparser.add<int>("branch", '\0', "Frames to run before branching", false, 600, cmdline::range(0, 1 << 20));
+    argparser.add<int>("sequences", 'n', "Input sequences to explore", false, 1000, cmdline::range(1, 1 << 20));
+    argparser.add<int>("length", 'l', "Frames per sequence", false, 60, cmdline::range(0, 1 << 16));
+    argparser.add<int>("jobs", 'j', "Workers for the parallel runs (0 for one per core)", false, 0);
+    argparser.parse_check(argc, argv);
+
+    auto rom = SharedImage::Load(argparser.get<std::string>("rom"), Gamate::MaxROMSize);
+    auto bios = SharedImage::Load(argparser.get<std::string>("bios"), Gamate::BIOSSize);
+
+    if (!rom || !bios) {
+        std::cerr << "Could not open " << (rom ? "BIOS file " + argparser.get<std::string>("bios") : "ROM file " + argparser.get<std::string>("rom")) << "\n";
+        return -1;
+    }
+
+    Gamate branch;
+    branch.setROM(rom);
+    branch.setBIOS(bios);
+    branch.reset();
+
+    for (int frame = 0; frame < argparser.get<int>("branch"); frame++)
+        branch.runFrame();
+
+    std::vector<Explorer::Sequence> sequences(argparser.get<int>("sequences"));
+    uint32_t random = 1;
+
+    for (auto &sequence : sequences) {
+        sequence.resize(argparser.get<int>("length"));
+
+        for (auto &buttons : sequence) {
+            random = random * 1664525 + 1013904223;
+            buttons = random >> 24;
+        }
+    }
+
+    size_t parallel = argparser.get<int>("jobs") > 0 ? argparser.get<int>("jobs") : std::max(1u, std::thread::hardware_concurrency());
+    std::vector<uint64_t> reference;
+    int status = 0;
+
+    printf("%-9s %5s %12s %14s %10s\n", "mode", "jobs", "seconds", "sequences/s", "us each");
+
+    for (size_t jobs : {(size_t)1, parallel}) {
+        for (Explorer::Mode mode : {Explorer::Snapshot, Explorer::Fork}) {
+            if (mode == Explorer::Fork && !Explorer::ForkSupported())
+                continue;
+
+            Explorer explorer(jobs);
+
+            if (!explorer.run(branch, sequences, mode)) {
+                std::cerr << "Could not explore every sequence\n";
+                return -1;
+            }
+
+            std::vector<uint64_t> hashes;
+            for (const auto &result : explorer.resultList())
+                hashes.push_back(result.hash);
+
+            if (reference.empty()) {
+                reference = hashes;
+            } else if (hashes != reference) {
+                std::cerr << "End states differ between runs\n";
+                status = -1;
+            }
+
+            printf("%-9s %5zu %12.3f %14.0f %10.1f\n", mode == Explorer::Fork ? "fork" : "snapshot", jobs, explorer.seconds(), sequences.size() / explorer.seconds(), explorer.seconds() * 1e6 / sequences.size());
+        }
+
+        if (parallel == 1)
+            break;
+    }
+
+    return status;
+}
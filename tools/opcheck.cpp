@@ -0,0 +1,181 @@
+/******************************************************************************
+
+Copyright (C) 2025 Neil Richardson (nrich@neiltopia.com)
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, version 3.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+
+******************************************************************************/
+
+
+#include <array>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+#include <cmdline.h>
+
+#include "CPU.h"
+#include "Opcodes.h"
+
+// B and R only exist on the stack, they are not flags the core keeps
+static const uint8_t RealFlags = FLAG::N|FLAG::V|FLAG::D|FLAG::I|FLAG::Z|FLAG::C;
+
+static std::string flag_names(uint8_t flags) {
+    static const char Names[] = "CZIDBRVN";
+    std::string names;
+
+    for (int bit = 7; bit >= 0; bit--) {
+        if (flags & (1 << bit))
+            names += Names[bit];
+    }
+
+    return names;
+}
+
+// a bare CPU on 64KiB of RAM that stops after one instruction
+struct Machine {
+    std::array<uint8_t, 0x10000> memory;
+    CPU cpu;
+
+    Machine() : cpu([this](uint16_t address) { return memory[address]; }, [this](uint16_t address, uint8_t value) { memory[address] = value; }, [] { return (uint8_t)INT::QUIT; }) {
+
+    }
+
+    void step(const std::array<uint8_t, 0x10000> &start, const CPU::State &state) {
+        memory = start;
+        cpu.loadState(state);
+        cpu.run();
+    }
+};
+
+/*
+    Checks the flags each opcode reads and writes in Opcodes.h against
+    the interpreter. Every opcode runs from random registers, operands
+    and memory. A flag it changes must be listed as written, and every
+    flag listed as written must change in some trial. Flipping a flag
+    before the instruction must only make a difference if the flag is
+    listed as read, and every flag listed as read must make a difference
+    in some trial. Exits non-zero on any disagreement.
+*/
+int main(int argc, char *argv[]) {
+    cmdline::parser argparser;
+    argparser.add<int>("trials", 'n', "Random starting states per opcode", false, 256, cmdline::range(1, 1 << 16));
+    argparser.parse_check(argc, argv);
+
+    int trials = argparser.get<int>("trials");
+    uint32_t random = 1;
+
+    auto next = [&random] {
+        random = random * 1664525 + 1013904223;
+        return (uint8_t)(random >> 24);
+    };
+
+    static Machine machine;
+    static Machine flipped;
+    static std::array<uint8_t, 0x10000> start;
+
+    int failures = 0;
+
+    for (int opcode = 0; opcode < 256; opcode++) {
+        const OpcodeInfo &op = Opcodes[opcode];
+
+        if (op.mode == AddressMode::Invalid)
+            continue;
+
+        for (auto &byte : start)
+            byte = next();
+
+        uint8_t changed = 0;
+        uint8_t mattered = 0;
+        uint8_t unlisted_writes = 0;
+        uint8_t unlisted_reads = 0;
+
+        for (int trial = 0; trial < trials; trial++) {
+            CPU::State state = {};
+            state.PC = 0x0200 + next() * 0x100 + next();
+            state.A = next();
+            state.X = next();
+            state.Y = next();
+            state.S = next();
+            state.P = next() | FLAG::R;
+            state.period = 1;
+            state.count = 1;
+            state.request = INT::NONE;
+
+            start[state.PC] = opcode;
+            start[(uint16_t)(state.PC + 1)] = next();
+            start[(uint16_t)(state.PC + 2)] = next();
+
+            machine.step(start, state);
+
+            CPU::State after;
+            machine.cpu.saveState(after);
+
+            changed |= (state.P ^ after.P) & RealFlags;
+            unlisted_writes |= (state.P ^ after.P) & RealFlags & ~op.flags_written;
+
+            for (uint8_t flag = 1; flag; flag <<= 1) {
+                if (!(flag & RealFlags))
+                    continue;
+
+                CPU::State other = state;
+                other.P ^= flag;
+                flipped.step(start, other);
+
+                CPU::State other_after;
+                flipped.cpu.saveState(other_after);
+
+                // a flag the instruction doesn't write comes out flipped without having been read
+                uint8_t compared = (op.flags_written & flag) ? 0xFF : (uint8_t)~flag;
+
+                bool differs = after.PC != other_after.PC || after.A != other_after.A || after.X != other_after.X || after.Y != other_after.Y || after.S != other_after.S
+                    || ((after.P ^ other_after.P) & compared) || machine.memory != flipped.memory;
+
+                if (differs) {
+                    mattered |= flag;
+
+                    if (!(op.flags_read & flag))
+                        unlisted_reads |= flag;
+                }
+            }
+        }
+
+        uint8_t never_written = op.flags_written & RealFlags & ~changed;
+        uint8_t never_read = op.flags_read & RealFlags & ~mattered;
+
+        if (unlisted_writes || never_written || unlisted_reads || never_read) {
+            printf("FAIL %02X %s:", opcode, op.mnemonic);
+
+            if (unlisted_writes)
+                printf(" writes %s not in the table", flag_names(unlisted_writes).c_str());
+            if (never_written)
+                printf(" never writes %s", flag_names(never_written).c_str());
+            if (unlisted_reads)
+                printf(" reads %s not in the table", flag_names(unlisted_reads).c_str());
+            if (never_read)
+                printf(" never reads %s", flag_names(never_read).c_str());
+
+            printf("\n");
+            failures++;
+        }
+    }
+
+    if (failures) {
+        printf("%d opcodes disagree with the table\n", failures);
+        return 1;
+    }
+
+    printf("PASS opcode flags agree with the interpreter\n");
+
+    return 0;
+}
@@ -0,0 +1,168 @@
+/******************************************************************************
+
+Copyright (C) 2025 Neil Richardson (nrich@neiltopia.com)
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, version 3.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+
+******************************************************************************/
+
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <thread>
+
+#include <cmdline.h>
+
+#include "FrameServer.h"
+#include "SharedFrames.h"
+#include "SharedImage.h"
+
+struct Followed {
+    uint64_t received = 0;
+    uint64_t dropped = 0;
+};
+
+// a client as in megata-shmclient on its own mapping, reading until frame count
+static void follow(const std::string &name, uint64_t count, bool lockstep, std::atomic<bool> &ready, Followed &followed) {
+    SharedFrames *frames = SharedFrames::Attach(name);
+
+    if (!frames) {
+        std::cerr << "Could not attach to " << name << "\n";
+        ready = true;
+        return;
+    }
+
+    uint32_t random = 1;
+    uint8_t shades[SharedFrames::Width*SharedFrames::Height];
+
+    if (lockstep) {
+        frames->control.active.store(1, std::memory_order_release);
+        frames->control.lockstep.store(1, std::memory_order_release);
+    }
+
+    ready = true;
+
+    for (uint64_t next = 0; next < count;) {
+        uint64_t published = frames->published.load(std::memory_order_acquire);
+
+        if (next >= published) {
+            std::this_thread::yield();
+            continue;
+        }
+
+        if (published - next > SharedFrames::SlotCount) {
+            followed.dropped += published - SharedFrames::SlotCount - next;
+            next = published - SharedFrames::SlotCount;
+        }
+
+        bool read = frames->read(next, [&](const SharedFrames::Slot &slot) {
+            std::copy(slot.shades, slot.shades + sizeof(shades), shades);
+        });
+
+        if (read) {
+            followed.received++;
+        } else {
+            followed.dropped++;
+        }
+
+        if (lockstep) {
+            // an agent choosing the next frame's buttons
+            random = random * 1664525 + 1013904223;
+            frames->control.buttons.store(random >> 24, std::memory_order_relaxed);
+        }
+
+        frames->control.consumed.store(++next, std::memory_order_release);
+    }
+
+    SharedFrames::Detach(frames);
+}
+
+/*
+    Measures what serving costs the emulation and what a client gets:
+    frames per second with no server, publishing with nobody reading,
+    with a client following every frame and with a client stepping the
+    server in lockstep, sending buttons after each frame it reads.
+*/
+int main(int argc, char *argv[]) {
+    cmdline::parser argparser;
+    argparser.add<std::string>("rom", 'r', "ROM file", true, "");
+    argparser.add<std::string>("bios", 'b', "BIOS file", true, "");
+    argparser.add<std::string>("name", 'n', "Shared memory name", false, "/megata-shmbench");
+    argparser.add<int>("frames", 'f', "Frames per run", false, 3000, cmdline::range(1, 1 << 24));
+    argparser.parse_check(argc, argv);
+
+    auto rom = SharedImage::Load(argparser.get<std::string>("rom"), Gamate::MaxROMSize);
+    auto bios = SharedImage::Load(argparser.get<std::string>("bios"), Gamate::BIOSSize);
+
+    if (!rom || !bios) {
+        std::cerr << "Could not open " << (rom ? "BIOS file " + argparser.get<std::string>("bios") : "ROM file " + argparser.get<std::string>("rom")) << "\n";
+        return -1;
+    }
+
+    std::string name = argparser.get<std::string>("name");
+    uint64_t count = argparser.get<int>("frames");
+
+    printf("%-10s %12s %10s %10s %10s\n", "run", "frames/s", "us/frame", "received", "dropped");
+
+    for (const char *run : {"none", "publish", "follow", "lockstep"}) {
+        std::string run_name = run;
+        Gamate gamate;
+        FrameServer server;
+
+        gamate.setROM(rom);
+        gamate.setBIOS(bios);
+        gamate.reset();
+
+        if (run_name != "none" && !server.open(name))
+            return -1;
+
+        std::atomic<bool> ready = false;
+        Followed followed;
+        std::thread client;
+
+        if (run_name == "follow" || run_name == "lockstep") {
+            client = std::thread(follow, name, count, run_name == "lockstep", std::ref(ready), std::ref(followed));
+
+            while (!ready) {
+                std::this_thread::yield();
+            }
+        }
+
+        auto start = std::chrono::steady_clock::now();
+
+        for (uint64_t frame = 0; frame < count; frame++) {
+            while (server.lockstep() && !server.caughtUp()) {
+                std::this_thread::yield();
+            }
+
+            gamate.running_state.button_state = 0xFF;
+            server.applyInput(gamate.running_state.button_state);
+
+            gamate.runFrame();
+            server.publish(gamate);
+        }
+
+        if (client.joinable())
+            client.join();
+
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        printf("%-10s %12.0f %10.2f %10llu %10llu\n", run, count / seconds, seconds * 1e6 / count, (unsigned long long)followed.received, (unsigned long long)followed.dropped);
+    }
+
+    return 0;
+}
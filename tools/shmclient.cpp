@@ -0,0 +1,153 @@
+/******************************************************************************
+
+Copyright (C) 2025 Neil Richardson (nrich@neiltopia.com)
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, version 3.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+
+******************************************************************************/
+
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+
+#include <cmdline.h>
+
+#include "SharedFrames.h"
+
+/*
+    Reference client for megata --serve, built from SharedFrames.h alone.
+    Follows the server's frames as they are published, optionally holding
+    buttons or running in lockstep, reports frames received and dropped
+    each second and can save the last frame it read as a PGM.
+*/
+int main(int argc, char *argv[]) {
+    cmdline::parser argparser;
+    argparser.add<std::string>("name", 'n', "Shared memory name the server was started with", false, "/megata");
+    argparser.add<int>("frames", 'f', "Frames to read (0 until the server stops)", false, 0, cmdline::range(0, 1 << 30));
+    argparser.add<std::string>("buttons", 'b', "Hex button mask to hold, set bits as in the C API", false, "");
+    argparser.add<std::string>("pgm", '\0', "Write the last frame read to a PGM file", false, "");
+    argparser.add("lockstep", '\0', "Hold a headless server on each frame until it has been read");
+    argparser.add("quit", '\0', "Stop a headless server on exit");
+    argparser.parse_check(argc, argv);
+
+    std::string name = argparser.get<std::string>("name");
+    SharedFrames *frames = SharedFrames::Attach(name);
+
+    if (!frames) {
+        std::cerr << "Could not attach to a server at " << name << "\n";
+        return -1;
+    }
+
+    SharedFrames::Control &control = frames->control;
+
+    if (argparser.get<std::string>("buttons").length()) {
+        control.buttons.store(std::stoul(argparser.get<std::string>("buttons"), nullptr, 16), std::memory_order_relaxed);
+        control.active.store(1, std::memory_order_release);
+    }
+
+    // start at the newest frame, the server may have been running for a while
+    uint64_t next = frames->published.load(std::memory_order_acquire);
+    uint64_t limit = argparser.get<int>("frames");
+    uint64_t received = 0;
+    uint64_t dropped = 0;
+
+    if (argparser.exist("lockstep")) {
+        control.consumed.store(next, std::memory_order_relaxed);
+        control.lockstep.store(1, std::memory_order_release);
+    }
+
+    uint8_t shades[SharedFrames::Width*SharedFrames::Height] = {};
+    uint32_t buttons = 0;
+
+    auto report_start = std::chrono::steady_clock::now();
+    uint64_t report_received = 0;
+    uint64_t report_dropped = 0;
+
+    while (!limit || received < limit) {
+        if (frames->magic != SharedFrames::Magic) {
+            std::cerr << "Server stopped\n";
+            break;
+        }
+
+        uint64_t published = frames->published.load(std::memory_order_acquire);
+
+        if (next >= published) {
+            std::this_thread::yield();
+            continue;
+        }
+
+        // frames older than the ring are gone
+        if (published - next > SharedFrames::SlotCount) {
+            dropped += published - SharedFrames::SlotCount - next;
+            next = published - SharedFrames::SlotCount;
+        }
+
+        bool read = frames->read(next, [&](const SharedFrames::Slot &slot) {
+            std::copy(slot.shades, slot.shades + sizeof(shades), shades);
+            buttons = slot.buttons;
+        });
+
+        if (read) {
+            received++;
+        } else {
+            dropped++;
+        }
+
+        control.consumed.store(++next, std::memory_order_release);
+
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - report_start;
+
+        if (elapsed.count() >= 1.0) {
+            printf("frame %llu: %.0f frames/s received, %llu dropped, buttons %02x\n", (unsigned long long)next - 1, (received - report_received) / elapsed.count(), (unsigned long long)(dropped - report_dropped), buttons);
+            fflush(stdout);
+
+            report_start = std::chrono::steady_clock::now();
+            report_received = received;
+            report_dropped = dropped;
+        }
+    }
+
+    control.lockstep.store(0, std::memory_order_release);
+    control.active.store(0, std::memory_order_release);
+
+    if (argparser.exist("quit")) {
+        control.quit.store(1, std::memory_order_release);
+    }
+
+    printf("%llu frames received, %llu dropped\n", (unsigned long long)received, (unsigned long long)dropped);
+
+    std::string pgm_path = argparser.get<std::string>("pgm");
+
+    if (pgm_path.length() && received) {
+        std::ofstream pgm(pgm_path, std::ios::binary);
+
+        if (!pgm) {
+            std::cerr << "Could not write " << pgm_path << "\n";
+        } else {
+            pgm << "P5\n" << SharedFrames::Width << " " << SharedFrames::Height << "\n255\n";
+
+            // shade 0 is the lightest
+            for (uint8_t shade : shades)
+                pgm.put((char)(255 - shade * 85));
+        }
+    }
+
+    SharedFrames::Detach(frames);
+
+    return 0;
+}
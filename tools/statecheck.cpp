@@ -0,0 +1,166 @@
+/******************************************************************************
+
+Copyright (C) 2025 Neil Richardson (nrich@neiltopia.com)
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, version 3.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+
+******************************************************************************/
+
+
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <cmdline.h>
+
+#include "SaveState.h"
+#include "SharedImage.h"
+
+static void run(Gamate &gamate, const std::vector<uint8_t> &inputs) {
+    for (uint8_t buttons : inputs) {
+        gamate.running_state.button_state = buttons;
+        gamate.runFrame();
+    }
+}
+
+// names each part of the machine state that differs, empty when they all match
+static std::string compare(const SaveState &a, const SaveState &b) {
+    std::string differences;
+
+    auto differ = [&](bool same, const char *part) {
+        if (!same)
+            differences += differences.empty() ? part : std::string(", ") + part;
+    };
+
+    std::vector<uint8_t> serialized_a(SaveState::SerializedSize());
+    std::vector<uint8_t> serialized_b(SaveState::SerializedSize());
+    a.save(serialized_a.data(), serialized_a.size());
+    b.save(serialized_b.data(), serialized_b.size());
+
+    LCD::State registers_a = a.lcd;
+    LCD::State registers_b = b.lcd;
+    registers_a.bitPlanes = registers_b.bitPlanes;
+
+    differ(a.cpu == b.cpu, "CPU");
+    differ(a.RAM == b.RAM, "RAM");
+    differ(a.lcd.bitPlanes == b.lcd.bitPlanes, "VRAM");
+    differ(registers_a == registers_b, "LCD");
+    differ(a.BIOS == b.BIOS && a.bank0_offset == b.bank0_offset && a.bank1_offset == b.bank1_offset && a.protection_check == b.protection_check, "banking");
+
+    // the PSG has no comparison of its own, anything else the file format holds is it
+    if (differences.empty())
+        differ(serialized_a == serialized_b, "PSG");
+
+    return differences;
+}
+
+/*
+    Save state round trip determinism check: runs N frames, saves a state
+    and passes it through the file format, runs M frames, then restores
+    the state into the same console and into a fresh one and runs the
+    same M frames again. Every run must end in the same CPU, RAM, VRAM,
+    LCD and PSG state. Exits non-zero on any difference.
+*/
+int main(int argc, char *argv[]) {
+    cmdline::parser argparser;
+    argparser.add<std::string>("rom", 'r', "ROM file", true, "");
+    argparser.add<std::string>("bios", 'b', "BIOS file", true, "");
+    argparser.add<int>("frames", 'n', "Frames to run before saving", false, 300, cmdline::range(0, 1 << 20));
+    argparser.add<int>("replay", 'm', "Frames to run after saving", false, 600, cmdline::range(1, 1 << 20));
+    argparser.parse_check(argc, argv);
+
+    auto rom = SharedImage::Load(argparser.get<std::string>("rom"), Gamate::MaxROMSize);
+    auto bios = SharedImage::Load(argparser.get<std::string>("bios"), Gamate::BIOSSize);
+
+    if (!rom || !bios) {
+        std::cerr << "Could not open " << (rom ? "BIOS file " + argparser.get<std::string>("bios") : "ROM file " + argparser.get<std::string>("rom")) << "\n";
+        return -1;
+    }
+
+    // the same pseudo random buttons every run, held low as the hardware reads them
+    std::vector<uint8_t> inputs(argparser.get<int>("frames") + argparser.get<int>("replay"));
+    uint32_t random = 1;
+
+    for (auto &buttons : inputs) {
+        random = random * 1664525 + 1013904223;
+        buttons = ~(random >> 24);
+    }
+
+    std::vector<uint8_t> before(inputs.begin(), inputs.begin() + argparser.get<int>("frames"));
+    std::vector<uint8_t> after(inputs.begin() + argparser.get<int>("frames"), inputs.end());
+
+    Gamate gamate;
+    gamate.setROM(rom);
+    gamate.setBIOS(bios);
+    gamate.reset();
+
+    run(gamate, before);
+
+    SaveState saved;
+    saved.capture(gamate);
+
+    std::vector<uint8_t> buffer(SaveState::SerializedSize());
+    std::vector<uint8_t> reserialized(SaveState::SerializedSize());
+    SaveState loaded;
+
+    if (!saved.save(buffer.data(), buffer.size()) || !loaded.load(buffer.data(), buffer.size()) || !loaded.save(reserialized.data(), reserialized.size())) {
+        std::cerr << "Could not pass the state through the file format\n";
+        return -1;
+    }
+
+    int status = 0;
+    std::string differences;
+
+    if (buffer != reserialized || !(differences = compare(saved, loaded)).empty()) {
+        printf("FAIL file round trip: %s\n", differences.empty() ? "bytes" : differences.c_str());
+        status = 1;
+    }
+
+    run(gamate, after);
+
+    SaveState reference;
+    reference.capture(gamate);
+
+    loaded.restore(gamate);
+    run(gamate, after);
+
+    SaveState replayed;
+    replayed.capture(gamate);
+
+    Gamate fresh;
+    fresh.setROM(rom);
+    fresh.setBIOS(bios);
+    fresh.reset();
+
+    loaded.restore(fresh);
+    run(fresh, after);
+
+    SaveState restored;
+    restored.capture(fresh);
+
+    if (!(differences = compare(reference, replayed)).empty()) {
+        printf("FAIL replay on the same console differs in %s\n", differences.c_str());
+        status = 1;
+    }
+
+    if (!(differences = compare(reference, restored)).empty()) {
+        printf("FAIL replay on a fresh console differs in %s\n", differences.c_str());
+        status = 1;
+    }
+
+    if (!status)
+        printf("PASS %zu byte state, %zu frames replayed after %zu\n", buffer.size(), after.size(), before.size());
+
+    return status;
+}
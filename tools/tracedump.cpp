@@ -0,0 +1,60 @@
+/******************************************************************************
+
+Copyright (C) 2025 Neil Richardson (nrich@neiltopia.com)
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, version 3.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+
+******************************************************************************/
+
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <cmdline.h>
+
+#include "InstructionTrace.h"
+
+/*
+    Decodes an instruction trace written by megata --itrace (or on a
+    crash) into one line of text per instruction.
+*/
+int main(int argc, char *argv[]) {
+    cmdline::parser argparser;
+    argparser.add<size_t>("tail", 'n', "Only decode the last N instructions (0 for all)", false, 0);
+    argparser.footer("trace.bin");
+    argparser.parse_check(argc, argv);
+
+    if (argparser.rest().size() != 1) {
+        std::cerr << argparser.usage();
+        return -1;
+    }
+
+    std::string filename = argparser.rest()[0];
+    std::vector<InstructionTrace::Record> records;
+
+    if (!InstructionTrace::Load(filename, records)) {
+        std::cerr << "Could not read instruction trace " << filename << "\n";
+        return -1;
+    }
+
+    size_t tail = argparser.get<size_t>("tail");
+    size_t start = tail && tail < records.size() ? records.size() - tail : 0;
+
+    std::cout << "       cycle B0:B1 PC    bytes     instruction    registers\n";
+
+    for (size_t i = start; i < records.size(); i++)
+        std::cout << InstructionTrace::Format(records[i]) << "\n";
+
+    return 0;
+}